@@ -1,45 +1,45 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-#ifndef all_components_included
-#define all_components_included
-
-#include "Components/ArrBez.h"
-#include "Components/Arrester.h"
-#include "Components/Capacitor.h"
-#include "Components/Customer.h"
-#include "Components/Ground.h"
-#include "Components/Inductor.h"
-#include "Components/Insulator.h"
-#include "Components/Line.h"
-#include "Components/LPM.h"
-#include "Components/Meter.h"
-#include "Components/Monitor.h"
-#include "Components/PipeGap.h"
-#include "Components/Pole.h"
-#include "Components/Resistor.h"
-#include "Components/Source.h"
-#include "Components/SteepFront.h"
-#include "Components/Surge.h"
-
-#include "Components/NewArr.h"
-#include "Components/Transformer.h"
-
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef all_components_included
+#define all_components_included
+
+#include "Components/ArrBez.h"
+#include "Components/Arrester.h"
+#include "Components/Capacitor.h"
+#include "Components/Customer.h"
+#include "Components/Ground.h"
+#include "Components/Inductor.h"
+#include "Components/Insulator.h"
+#include "Components/Line.h"
+#include "Components/LPM.h"
+#include "Components/Meter.h"
+#include "Components/Monitor.h"
+#include "Components/PipeGap.h"
+#include "Components/Pole.h"
+#include "Components/Resistor.h"
+#include "Components/Source.h"
+#include "Components/SteepFront.h"
+#include "Components/Surge.h"
+
+#include "Components/NewArr.h"
+#include "Components/Transformer.h"
+
 #endif
\ No newline at end of file
@@ -1,287 +1,747 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-/* This file contains functions to increase the time step during
-a simulation. */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_matrix.h>
-#include <gsl/gsl_linalg.h>
-
-#include "ChangeTimeStep.h"
-#include "OETypes.h"
-#include "OEEngine.h"
-#include "Components/ArrBez.h"
-#include "Components/Arrester.h"
-#include "Components/Capacitor.h"
-#include "Components/Customer.h"
-#include "Components/Ground.h"
-#include "Components/Inductor.h"
-#include "Components/Line.h"
-#include "Components/Pole.h"
-
-char time_token[] = "time";
-char change_dt_token[] = "2dt";
-
-void change_customer_time_step (struct customer *ptr);
-void change_capacitor_time_step (struct capacitor *ptr);
-void change_inductor_time_step (struct inductor *ptr);
-void change_arrester_time_step (struct arrester *ptr);
-void change_arrbez_time_step (struct arrbez *ptr);
-void change_line_time_step (struct line *ptr);
-void change_ground_time_step (struct ground *ptr);
-
-void restore_customer_time_step (struct customer *ptr);
-void restore_capacitor_time_step (struct capacitor *ptr);
-void restore_inductor_time_step (struct inductor *ptr);
-void restore_arrester_time_step (struct arrester *ptr);
-void restore_arrbez_time_step (struct arrbez *ptr);
-void restore_line_time_step (struct line *ptr);
-void restore_ground_time_step (struct ground *ptr);
-
-double first_dT;
-double second_dT;
-double dT_switch_time;
-int dT_switched;
-int using_second_dT;
-
-/* these three functions are called at the system level */
-
-void restore_time_step (void)
-{
-	if (!dT_switched) return;
-
-	dT = first_dT;
-
-	do_all_arrbezs (restore_arrbez_time_step);
-	do_all_arresters (restore_arrester_time_step);
-	do_all_capacitors (restore_capacitor_time_step);
-	do_all_customers (restore_customer_time_step);
-	do_all_grounds (restore_ground_time_step);
-	do_all_inductors (restore_inductor_time_step);
-	do_all_lines (restore_line_time_step);
-
-	dT_switched = FALSE;
-}
-
-void change_time_step (void)
-{
-	dT = second_dT;
-
-	do_all_arrbezs (change_arrbez_time_step);
-	do_all_arresters (change_arrester_time_step);
-	do_all_capacitors (change_capacitor_time_step);
-	do_all_customers (change_customer_time_step);
-	do_all_grounds (change_ground_time_step);
-	do_all_inductors (change_inductor_time_step);
-	do_all_lines (change_line_time_step);
-
-	do_all_poles (triang_pole);
-
-	dT_switched = TRUE;
-}
-
-/* arrbez functions to support second_dT */
-
-void change_arrbez_time_step (struct arrbez *ptr)
-{
-	double vl = ptr->rl * (ptr->amps - ptr->h);
-
-	ptr->rl *= (first_dT / second_dT);
-	ptr->gl *= (second_dT / first_dT);
-    ptr->r = ptr->rl + ptr->rgap + 1.0 / ptr->g;
-
-	ptr->h = ptr->amps - 0.5 * ptr->gl * vl;
-}
-
-void restore_arrbez_time_step (struct arrbez *ptr)
-{
-	ptr->rl *= (second_dT / first_dT);
-	ptr->gl *= (first_dT / second_dT);
-    ptr->r = ptr->rl + ptr->rgap + 1.0 / ptr->g;
-}
-
-/* arrester functions to support second_dT */
-
-void change_arrester_time_step (struct arrester *ptr)
-{
-	double old_y = ptr->y;
-	double volts, vl, vr;
-	int pos_now;
-
-	ptr->zl *= (first_dT / second_dT);
-	ptr->y = 1.0 / (ptr->r_slope + ptr->zl);
-	ptr->yr = ptr->y * ptr->r_slope;
-	ptr->yzl = ptr->y * ptr->zl;
-	if (ptr->conducting) {
-		add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-		volts = gsl_vector_get (ptr->parent->voltage, ptr->from) - gsl_vector_get (ptr->parent->voltage, ptr->to);
-		if (volts > 0.0) {
-			pos_now = TRUE;
-			vr = ptr->r_slope * (ptr->amps + ptr->i_bias);
-		} else {
-			pos_now = FALSE;
-			vr = ptr->r_slope * (ptr->amps - ptr->i_bias);
-		}
-		vl = volts - vr;
-		if (ptr->zl > 0.0) {
-			ptr->h = ptr->amps + vl / ptr->zl;
-		}
-		ptr->i = ptr->h * ptr->yzl;
-		if (pos_now) {
-			ptr->i -= ptr->yr * ptr->i_bias;
-		} else {
-			ptr->i += ptr->yr * ptr->i_bias;
-		}
-		ptr->i_past = ptr->i;
-	} 
-}
-
-void restore_arrester_time_step (struct arrester *ptr)
-{
-//	double old_y = ptr->y;
-
-	ptr->zl *= (second_dT / first_dT);
-	ptr->y = 1.0 / (ptr->r_slope + ptr->zl);
-	ptr->yr = ptr->y * ptr->r_slope;
-	ptr->yzl = ptr->y * ptr->zl;
-//	if (ptr->conducting) {
-//		add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-//	}
-}
-
-/* capacitor functions to support second_dT */
-
-void change_capacitor_time_step (struct capacitor *ptr)
-{
-	double old_y = ptr->y;
-
-	ptr->y *= (first_dT / second_dT);
-	ptr->yc = ptr->y + ptr->y;
-	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-
-	ptr->h *= (first_dT / second_dT);
-}
-
-void restore_capacitor_time_step (struct capacitor *ptr)
-{
-	double old_y = ptr->y;
-
-	ptr->y *= (second_dT / first_dT);
-	ptr->yc = ptr->y + ptr->y;
-	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-}
-
-/* customer functions to support second_dT */
-
-void change_customer_time_step (struct customer *ptr)
-{
-	ptr->Kv *= (second_dT / first_dT);
-}
-
-void restore_customer_time_step (struct customer *ptr)
-{
-	ptr->Kv *= (first_dT / second_dT);
-}
-
-/* ground functions to support second_dT */
-
-void change_ground_time_step (struct ground *ptr)
-{
-	double old_y = ptr->y;
-	double Vl, Vg, Vt;
-
-	ptr->zl *= (first_dT / second_dT);
-	ptr->y = 1.0 / (ptr->R60 + ptr->zl);
-	ptr->yr = ptr->y * ptr->R60;
-	ptr->yzl = ptr->y * ptr->zl;
-	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-
-	Vt = gsl_vector_get (ptr->parent->voltage, ptr->from) - gsl_vector_get (ptr->parent->voltage, ptr->to);
-	Vg = ptr->amps * ptr->Ri;
-	Vl = Vt - Vg;
-	if (ptr->zl > 0.0) {
-		ptr->h = ptr->amps + Vl / ptr->zl;
-	} else {
-		ptr->h = 0.0;
-	}
-	ptr->i = ptr->h * ptr->yzl + ptr->i_bias * ptr->yr;
-}
-
-void restore_ground_time_step (struct ground *ptr)
-{
-	double old_y = ptr->y;
-
-	ptr->zl *= (second_dT / first_dT);
-	ptr->y = 1.0 / (ptr->R60 + ptr->zl);
-	ptr->yr = ptr->y * ptr->R60;
-	ptr->yzl = ptr->y * ptr->zl;
-	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-}
-
-/* inductor functions to support second_dT */
-
-void change_inductor_time_step (struct inductor *ptr)
-{
-	double old_y = ptr->y;
-	double Vt, It;
-
-	Vt = gsl_vector_get (ptr->parent->voltage, ptr->from) - gsl_vector_get (ptr->parent->voltage, ptr->to);
-	It = old_y * Vt + ptr->h;
-
-	ptr->y = 1.0 / (ptr->res + 2.0 * ptr->ind / dT);
-	ptr->yi = 2.0 * ptr->y * (1.0 - ptr->res * ptr->y);
-	ptr->zi = 1.0 - 2.0 * ptr->res * ptr->y;
-	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-
-	ptr->h = ptr->y * ((2.0 * ptr->ind / dT - ptr->res) * It + Vt);
-}
-
-void restore_inductor_time_step (struct inductor *ptr)
-{
-	double old_y = ptr->y;
-
-	ptr->y = 1.0 / (ptr->res + 2.0 * ptr->ind / dT);
-	ptr->yi = 2.0 * ptr->y * (1.0 - ptr->res * ptr->y);
-	ptr->zi = 1.0 - 2.0 * ptr->res * ptr->y;
-	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
-}
-
-/* line functions to support second_dT */
-
-void change_line_time_step (struct line *ptr)
-{
-	int i, k;
-
-	k = step % ptr->steps;
-	for (i = 0; i < number_of_conductors; i++) {
-		gsl_matrix_set (ptr->hist_left, i, 0, gsl_matrix_get (ptr->hist_left, i, k));
-		gsl_matrix_set (ptr->hist_right, i, 0, gsl_matrix_get (ptr->hist_right, i, k));
-	}
-	ptr->steps = 1;
-}
-
-void restore_line_time_step (struct line *ptr)
-{
-	ptr->steps = ptr->alloc_steps;
-}
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This file contains functions to increase the time step during
+a simulation. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_linalg.h>
+
+#include "ChangeTimeStep.h"
+#include "OETypes.h"
+#include "OEEngine.h"
+#include "Components/ArrBez.h"
+#include "Components/Arrester.h"
+#include "Components/Capacitor.h"
+#include "Components/Customer.h"
+#include "Components/Ground.h"
+#include "Components/Inductor.h"
+#include "Components/Insulator.h"
+#include "Components/Line.h"
+#include "Components/PipeGap.h"
+#include "Components/Pole.h"
+
+char time_token[] = "time";
+char change_dt_token[] = "2dt";
+
+void change_customer_time_step (struct customer *ptr);
+void change_capacitor_time_step (struct capacitor *ptr);
+void change_inductor_time_step (struct inductor *ptr);
+void change_arrester_time_step (struct arrester *ptr);
+void change_arrbez_time_step (struct arrbez *ptr);
+void change_line_time_step (struct line *ptr);
+void change_ground_time_step (struct ground *ptr);
+
+void restore_customer_time_step (struct customer *ptr);
+void restore_capacitor_time_step (struct capacitor *ptr);
+void restore_inductor_time_step (struct inductor *ptr);
+void restore_arrester_time_step (struct arrester *ptr);
+void restore_arrbez_time_step (struct arrbez *ptr);
+void restore_line_time_step (struct line *ptr);
+void restore_ground_time_step (struct ground *ptr);
+
+double first_dT;
+double second_dT;
+double dT_switch_time;
+int dT_switched;
+int using_second_dT;
+
+/* these three functions are called at the system level */
+
+void restore_time_step (void)
+{
+	if (!dT_switched) return;
+
+	dT = first_dT;
+
+	do_all_arrbezs (restore_arrbez_time_step);
+	do_all_arresters (restore_arrester_time_step);
+	do_all_capacitors (restore_capacitor_time_step);
+	do_all_customers (restore_customer_time_step);
+	do_all_grounds (restore_ground_time_step);
+	do_all_inductors (restore_inductor_time_step);
+	do_all_lines (restore_line_time_step);
+
+	dT_switched = FALSE;
+}
+
+void change_time_step (void)
+{
+	dT = second_dT;
+
+	do_all_arrbezs (change_arrbez_time_step);
+	do_all_arresters (change_arrester_time_step);
+	do_all_capacitors (change_capacitor_time_step);
+	do_all_customers (change_customer_time_step);
+	do_all_grounds (change_ground_time_step);
+	do_all_inductors (change_inductor_time_step);
+	do_all_lines (change_line_time_step);
+
+	do_all_poles (triang_pole);
+
+	dT_switched = TRUE;
+}
+
+/* arrbez functions to support second_dT */
+
+void change_arrbez_time_step (struct arrbez *ptr)
+{
+	double vl = ptr->rl * (ptr->amps - ptr->h);
+
+	ptr->rl *= (first_dT / second_dT);
+	ptr->gl *= (second_dT / first_dT);
+    ptr->r = ptr->rl + ptr->rgap + 1.0 / ptr->g;
+
+	ptr->h = ptr->amps - 0.5 * ptr->gl * vl;
+}
+
+void restore_arrbez_time_step (struct arrbez *ptr)
+{
+	ptr->rl *= (second_dT / first_dT);
+	ptr->gl *= (first_dT / second_dT);
+    ptr->r = ptr->rl + ptr->rgap + 1.0 / ptr->g;
+}
+
+/* arrester functions to support second_dT */
+
+void change_arrester_time_step (struct arrester *ptr)
+{
+	double old_y = ptr->y;
+	double volts, vl, vr;
+	int pos_now;
+
+	ptr->zl *= (first_dT / second_dT);
+	ptr->y = 1.0 / (ptr->r_slope + ptr->zl);
+	ptr->yr = ptr->y * ptr->r_slope;
+	ptr->yzl = ptr->y * ptr->zl;
+	if (ptr->conducting) {
+		add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+		volts = gsl_vector_get (ptr->parent->voltage, ptr->from) - gsl_vector_get (ptr->parent->voltage, ptr->to);
+		if (volts > 0.0) {
+			pos_now = TRUE;
+			vr = ptr->r_slope * (ptr->amps + ptr->i_bias);
+		} else {
+			pos_now = FALSE;
+			vr = ptr->r_slope * (ptr->amps - ptr->i_bias);
+		}
+		vl = volts - vr;
+		if (ptr->zl > 0.0) {
+			ptr->h = ptr->amps + vl / ptr->zl;
+		}
+		ptr->i = ptr->h * ptr->yzl;
+		if (pos_now) {
+			ptr->i -= ptr->yr * ptr->i_bias;
+		} else {
+			ptr->i += ptr->yr * ptr->i_bias;
+		}
+		ptr->i_past = ptr->i;
+	} 
+}
+
+void restore_arrester_time_step (struct arrester *ptr)
+{
+//	double old_y = ptr->y;
+
+	ptr->zl *= (second_dT / first_dT);
+	ptr->y = 1.0 / (ptr->r_slope + ptr->zl);
+	ptr->yr = ptr->y * ptr->r_slope;
+	ptr->yzl = ptr->y * ptr->zl;
+//	if (ptr->conducting) {
+//		add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+//	}
+}
+
+/* capacitor functions to support second_dT */
+
+void change_capacitor_time_step (struct capacitor *ptr)
+{
+	double old_y = ptr->y;
+
+	ptr->y *= (first_dT / second_dT);
+	ptr->yc = ptr->y + ptr->y;
+	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+
+	ptr->h *= (first_dT / second_dT);
+}
+
+void restore_capacitor_time_step (struct capacitor *ptr)
+{
+	double old_y = ptr->y;
+
+	ptr->y *= (second_dT / first_dT);
+	ptr->yc = ptr->y + ptr->y;
+	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+}
+
+/* customer functions to support second_dT */
+
+void change_customer_time_step (struct customer *ptr)
+{
+	ptr->Kv *= (second_dT / first_dT);
+}
+
+void restore_customer_time_step (struct customer *ptr)
+{
+	ptr->Kv *= (first_dT / second_dT);
+}
+
+/* ground functions to support second_dT */
+
+void change_ground_time_step (struct ground *ptr)
+{
+	double old_y = ptr->y;
+	double Vl, Vg, Vt;
+
+	ptr->zl *= (first_dT / second_dT);
+	ptr->y = 1.0 / (ptr->R60 + ptr->zl);
+	ptr->yr = ptr->y * ptr->R60;
+	ptr->yzl = ptr->y * ptr->zl;
+	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+
+	Vt = gsl_vector_get (ptr->parent->voltage, ptr->from) - gsl_vector_get (ptr->parent->voltage, ptr->to);
+	Vg = ptr->amps * ptr->Ri;
+	Vl = Vt - Vg;
+	if (ptr->zl > 0.0) {
+		ptr->h = ptr->amps + Vl / ptr->zl;
+	} else {
+		ptr->h = 0.0;
+	}
+	ptr->i = ptr->h * ptr->yzl + ptr->i_bias * ptr->yr;
+}
+
+void restore_ground_time_step (struct ground *ptr)
+{
+	double old_y = ptr->y;
+
+	ptr->zl *= (second_dT / first_dT);
+	ptr->y = 1.0 / (ptr->R60 + ptr->zl);
+	ptr->yr = ptr->y * ptr->R60;
+	ptr->yzl = ptr->y * ptr->zl;
+	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+}
+
+/* inductor functions to support second_dT */
+
+void change_inductor_time_step (struct inductor *ptr)
+{
+	double old_y = ptr->y;
+	double Vt, It;
+
+	Vt = gsl_vector_get (ptr->parent->voltage, ptr->from) - gsl_vector_get (ptr->parent->voltage, ptr->to);
+	It = old_y * Vt + ptr->h;
+
+	ptr->y = 1.0 / (ptr->res + 2.0 * ptr->ind / dT);
+	ptr->yi = 2.0 * ptr->y * (1.0 - ptr->res * ptr->y);
+	ptr->zi = 1.0 - 2.0 * ptr->res * ptr->y;
+	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+
+	ptr->h = ptr->y * ((2.0 * ptr->ind / dT - ptr->res) * It + Vt);
+}
+
+void restore_inductor_time_step (struct inductor *ptr)
+{
+	double old_y = ptr->y;
+
+	ptr->y = 1.0 / (ptr->res + 2.0 * ptr->ind / dT);
+	ptr->yi = 2.0 * ptr->y * (1.0 - ptr->res * ptr->y);
+	ptr->zi = 1.0 - 2.0 * ptr->res * ptr->y;
+	add_y (ptr->parent, ptr->from, ptr->to, ptr->y - old_y);
+}
+
+/* line functions to support second_dT */
+
+void change_line_time_step (struct line *ptr)
+{
+	int i, k;
+
+	k = step % ptr->steps;
+	for (i = 0; i < number_of_conductors; i++) {
+		gsl_matrix_set (ptr->hist_left, i, 0, gsl_matrix_get (ptr->hist_left, i, k));
+		gsl_matrix_set (ptr->hist_right, i, 0, gsl_matrix_get (ptr->hist_right, i, k));
+	}
+	ptr->steps = 1;
+}
+
+void restore_line_time_step (struct line *ptr)
+{
+	ptr->steps = ptr->alloc_steps;
+}
+
+/* With substep_switching, components find when a quantity that went from past
+at the last step to now at this one crossed a threshold, by straight-line
+interpolation within the step.  The reported times and the charge, energy
+and DE integrals use the crossing, and switch_within_step has the network
+switch there too. */
+
+double crossing_time (double past, double now, double level)
+{
+	double frac = 1.0;
+
+	if (step < 1) {
+		return t;
+	}
+	if (now != past) {
+		frac = (level - past) / (now - past);
+		if (frac < 0.0) {
+			frac = 0.0;
+		} else if (frac > 1.0) {
+			frac = 1.0;
+		}
+	}
+	return t - dT + frac * dT;
+}
+
+/* With substep_switching, a component that switches within the step reports
+the crossing x at its pole to switch_within_step.  After the step's history
+updates, resync_switching interpolates that pole's state back to x - dT,
+takes two steps of dT from there with the new topology, to x and to x + dT,
+and interpolates between those two to the grid again, as in the EMTP
+interpolation method.  The lines delay everything between poles by at least
+dT, so the other poles keep the solution they have, and resync_pole keeps
+the do_all_X functions to the poles being solved again.  The state is the
+list of doubles that the substep_X functions walk in a fixed order, each
+value being the one as of the step just solved.  Each step starts by saving
+it on the STATE_PAST tape, followed by the line history slots that the step
+will read and overwrite, and the step before's goes to STATE_PAST2. */
+
+#define STATE_PAST2 0
+#define STATE_PAST 1
+#define STATE_CROSS 2
+#define STATE_TAPES 3
+#define STATE_NONE -1
+#define STATE_LIVE -2
+
+int substep_resync = FALSE;
+
+static double *state_tape[STATE_TAPES] = {NULL, NULL, NULL};
+static int state_size = 0;
+static int state_n;       /* position on the tapes */
+static int state_lines;   /* where the line history slots start */
+static int state_save;    /* tape that the walk saves the values on */
+static int state_from;    /* tape that the walk interpolates from, */
+static int state_to;      /* toward this tape or the present values, */
+static double state_w;    /* this fraction of the way */
+static int state_keep;    /* TRUE to leave the present values alone */
+static int switch_pending = FALSE;
+static double switch_t;   /* the crossing being solved from */
+
+static void state_value (double *x)
+{
+	double *tape, a, b;
+	int i;
+
+	if (state_n >= state_size) {
+		state_size = state_size ? 2 * state_size : 256;
+		for (i = 0; i < STATE_TAPES; i++) {
+			if ((tape = (double *) realloc (state_tape[i], state_size * sizeof (double))) == NULL) {
+				if (logfp) fprintf (logfp, "can't allocate the substep state\n");
+				oe_exit (ERR_MALLOC);
+			}
+			state_tape[i] = tape;
+		}
+	}
+	if (state_from != STATE_NONE && !state_keep) {
+		a = state_tape[state_from][state_n];
+		b = (state_to == STATE_LIVE) ? *x : state_tape[state_to][state_n];
+		*x = a + state_w * (b - a);
+	}
+	if (state_save != STATE_NONE) {
+		state_tape[state_save][state_n] = *x;
+	}
+	++state_n;
+}
+
+/* an arrester or pipegap that changed state since the state being
+interpolated from keeps the state it switched to, instead of one interpolated
+from before it switched, and one that changed state in the step before x - dT
+takes the state it had at the end of that step.  Its conducting flag goes on
+the tapes as it is, to tell. */
+
+static int switched_from, switched_keep;
+static double switched_w;
+
+static void begin_switched (int conducting)
+{
+	double x = conducting;
+	int n = state_n;
+
+	switched_from = state_from;
+	switched_w = state_w;
+	switched_keep = state_keep;
+	state_keep = TRUE;
+	state_value (&x);
+	state_keep = switched_keep;
+	if (state_from == STATE_CROSS && state_tape[STATE_CROSS][n] != x) {
+		state_keep = TRUE;
+	} else if (state_from == STATE_PAST2) {
+		if (state_tape[STATE_PAST][n] != x) {
+			state_keep = TRUE;
+		} else if (state_tape[STATE_PAST2][n] != x) {
+			state_from = STATE_PAST;
+			state_w = 0.0;
+		}
+	}
+}
+
+static void end_switched (void)
+{
+	state_from = switched_from;
+	state_w = switched_w;
+	state_keep = switched_keep;
+}
+
+/* a peak goes back to the one before this step, for the steps from the
+crossing to go on from, and is not interpolated forward */
+
+static void state_peak (double *x)
+{
+	int from = state_from, keep = state_keep;
+	double w = state_w;
+
+	if (state_from == STATE_PAST2) {
+		state_from = STATE_PAST;
+		state_w = 0.0;
+	} else {
+		state_keep = TRUE;
+	}
+	state_value (x);
+	state_from = from;
+	state_w = w;
+	state_keep = keep;
+}
+
+/* only the poles being solved again from the crossing are interpolated */
+
+static int in_resync (struct pole *ptr)
+{
+	return ptr->resync && ptr->t_resync == switch_t;
+}
+
+static void state_pole (struct pole *ptr)
+{
+	state_keep = !in_resync (ptr);
+}
+
+static void substep_pole (struct pole *ptr)
+{
+	size_t i;
+
+	state_pole (ptr);
+	for (i = 0; i < ptr->voltage->size; i++) {
+		state_value (gsl_vector_ptr (ptr->voltage, i));
+	}
+	for (i = 0; i < ptr->vmode->size; i++) {
+		state_value (gsl_vector_ptr (ptr->vmode, i));
+	}
+}
+
+static void substep_inductor (struct inductor *ptr)
+{
+	state_pole (ptr->parent);
+	state_value (&ptr->h);
+}
+
+static void substep_capacitor (struct capacitor *ptr)
+{
+	state_pole (ptr->parent);
+	state_value (&ptr->h);
+}
+
+static void substep_ground (struct ground *ptr)
+{
+	state_pole (ptr->parent);
+	state_value (&ptr->Ri);
+	state_value (&ptr->h);
+	state_value (&ptr->i);
+	state_value (&ptr->i_bias);
+	state_value (&ptr->ic);
+	state_value (&ptr->amps);
+}
+
+static void substep_arrester (struct arrester *ptr)
+{
+	state_pole (ptr->parent);
+	begin_switched (ptr->conducting);
+	state_value (&ptr->i_bias);
+	state_value (&ptr->h);
+	state_value (&ptr->i);
+	state_value (&ptr->i_past);
+	state_value (&ptr->amps);
+	end_switched ();
+	state_value (&ptr->v_past);
+	state_value (&ptr->charge);
+	state_value (&ptr->energy);
+	state_peak (&ptr->i_peak);
+	state_peak (&ptr->t_peak);
+}
+
+static void substep_arrbez (struct arrbez *ptr)
+{
+	state_pole (ptr->parent);
+	state_value (&ptr->g);
+	state_value (&ptr->h);
+	state_value (&ptr->amps);
+	state_value (&ptr->varr);
+	state_value (&ptr->v_past);
+	state_value (&ptr->charge);
+	state_value (&ptr->energy);
+	state_peak (&ptr->i_peak);
+	state_peak (&ptr->t_peak);
+	ptr->r = ptr->rl + ptr->rgap + 1.0 / ptr->g;
+}
+
+static void substep_pipegap (struct pipegap *ptr)
+{
+	state_pole (ptr->parent);
+	begin_switched (ptr->conducting);
+	state_value (&ptr->i_past);
+	state_value (&ptr->amps);
+	end_switched ();
+	state_peak (&ptr->i_peak);
+}
+
+static void substep_customer (struct customer *ptr)
+{
+	state_pole (ptr->parent);
+	state_value (&ptr->integral);
+	state_value (&ptr->Ix2);
+	state_peak (&ptr->Ihg);
+	state_peak (&ptr->Vp);
+	state_peak (&ptr->Ix2_peak);
+}
+
+/* the history slot that this step reads and then overwrites */
+
+static void substep_line (struct line *ptr)
+{
+	size_t i;
+	int k = step % ptr->steps;
+
+	for (i = 0; i < ptr->hist_left->size1; i++) {
+		state_value (gsl_matrix_ptr (ptr->hist_left, i, k));
+		state_value (gsl_matrix_ptr (ptr->hist_right, i, k));
+	}
+}
+
+/* for the step to x + dT, the slot takes the history from one travel time
+before, between the STATE_PAST tape and the slot for the next step.  With one
+step of travel time that is the entry this step made, on the STATE_CROSS
+tape. */
+
+static void substep_line_ahead (struct line *ptr)
+{
+	size_t i;
+	int k = step % ptr->steps;
+	int k_next = (step + 1) % ptr->steps;
+
+	for (i = 0; i < ptr->hist_left->size1; i++) {
+		if (k_next != k) {
+			gsl_matrix_set (ptr->hist_left, i, k, gsl_matrix_get (ptr->hist_left, i, k_next));
+			gsl_matrix_set (ptr->hist_right, i, k, gsl_matrix_get (ptr->hist_right, i, k_next));
+		} else {
+			gsl_matrix_set (ptr->hist_left, i, k, state_tape[STATE_CROSS][state_n]);
+			gsl_matrix_set (ptr->hist_right, i, k, state_tape[STATE_CROSS][state_n + 1]);
+		}
+		state_value (gsl_matrix_ptr (ptr->hist_left, i, k));
+		state_value (gsl_matrix_ptr (ptr->hist_right, i, k));
+	}
+}
+
+static void substep_insulator (struct insulator *ptr)
+{
+	ptr->v_past = gsl_vector_get (ptr->parent->voltage, ptr->from) - 
+		gsl_vector_get (ptr->parent->voltage, ptr->to);
+}
+
+static void set_walk (int save, int from, int to, double w)
+{
+	state_save = save;
+	state_from = from;
+	state_to = to;
+	state_w = w;
+	state_keep = FALSE;
+}
+
+static void walk_state (int save, int from, int to, double w)
+{
+	set_walk (save, from, to, w);
+	state_n = 0;
+	do_all_poles (substep_pole);
+	do_all_inductors (substep_inductor);
+	do_all_capacitors (substep_capacitor);
+	do_all_grounds (substep_ground);
+	do_all_arresters (substep_arrester);
+	do_all_arrbezs (substep_arrbez);
+	do_all_pipegaps (substep_pipegap);
+	do_all_customers (substep_customer);
+}
+
+static void walk_line_slots (int save, int from, int to, double w, void (*verb) (struct line *))
+{
+	set_walk (save, from, to, w);
+	state_n = state_lines;
+	do_all_lines (verb);
+}
+
+/* called before solving each step */
+
+void save_step_state (void)
+{
+	double *tape = state_tape[STATE_PAST2];
+
+	state_tape[STATE_PAST2] = state_tape[STATE_PAST];
+	state_tape[STATE_PAST] = tape;
+	switch_pending = FALSE;
+	walk_state (STATE_PAST, STATE_NONE, STATE_NONE, 0.0);
+	state_lines = state_n;
+	do_all_lines (substep_line);
+}
+
+/* a component at pole ptr switched at time at, within the step just solved.
+Returns TRUE if the pole will be solved again from the crossing, so that the
+step need not be solved again now. */
+
+int switch_within_step (struct pole *ptr, double at)
+{
+	if (!substep_switching || substep_resync || step < 1) {
+		return FALSE;
+	}
+	if (!ptr->resync || at < ptr->t_resync) {
+		ptr->t_resync = at;
+		ptr->resync = TRUE;
+	}
+	switch_pending = TRUE;
+	return TRUE;
+}
+
+/* TRUE if pole ptr will be solved again from a crossing at or before at,
+so that integrals should not yet count from at to the end of the step */
+
+int resync_pending (struct pole *ptr, double at)
+{
+	return ptr->resync && ptr->t_resync <= at;
+}
+
+/* the do_all_X functions skip the components of other poles while a pole is
+solved again from its crossing, and those of lines between two other poles */
+
+int resync_pole (struct pole *ptr)
+{
+	return !substep_resync || in_resync (ptr);
+}
+
+static void earliest_resync (struct pole *ptr)
+{
+	if (ptr->resync && (!switch_pending || ptr->t_resync < switch_t)) {
+		switch_t = ptr->t_resync;
+		switch_pending = TRUE;
+	}
+}
+
+static void end_resync (struct pole *ptr)
+{
+	if (in_resync (ptr)) {
+		ptr->resync = FALSE;
+	}
+}
+
+/* solve the poles that switched at the crossing switch_t again from there */
+
+static void resync_poles (void)
+{
+	double frac, t_grid;
+
+	frac = (switch_t - (t - dT)) / dT;
+	if (frac < 0.0) {
+		frac = 0.0;
+	} else if (frac > 1.0) {
+		frac = 1.0;
+	}
+	t_grid = t;
+/* back to x - dT, then the step to x */
+	walk_line_slots (STATE_CROSS, STATE_NONE, STATE_NONE, 0.0, substep_line);
+	walk_state (STATE_NONE, STATE_PAST2, STATE_PAST, frac);
+	walk_line_slots (STATE_NONE, STATE_PAST2, STATE_PAST, frac, substep_line);
+	t = switch_t;
+	substep_resync = TRUE;
+	solve_time_step ();
+	do_all_grounds (check_ground);
+	update_lumped_history ();
+	if (!using_multiple_span_defns) {
+		do_all_poles (calc_pole_vmode);
+	}
+	substep_resync = FALSE;
+	walk_state (STATE_CROSS, STATE_NONE, STATE_NONE, 0.0);
+/* and the step to x + dT */
+	walk_line_slots (STATE_NONE, STATE_PAST, STATE_LIVE, frac, substep_line_ahead);
+	t = switch_t + dT;
+	substep_resync = TRUE;
+	solve_time_step ();
+	do_all_grounds (check_ground);
+	update_lumped_history ();
+	if (!using_multiple_span_defns) {
+		do_all_poles (calc_pole_vmode);
+	}
+	substep_resync = FALSE;
+	t = t_grid;
+/* forward to the grid, and the line history entries for this step again */
+	walk_state (STATE_NONE, STATE_CROSS, STATE_LIVE, 1.0 - frac);
+	walk_line_slots (STATE_NONE, STATE_PAST, STATE_PAST, 0.0, substep_line);
+	if (using_multiple_span_defns) {
+		do_all_lines (update_vmode_and_history);
+	} else {
+		do_all_lines (update_line_history);
+	}
+}
+
+/* called after the step's history updates, to move the switches from the
+grid to their crossings, one crossing at a time */
+
+void resync_switching (void)
+{
+	if (!switch_pending) {
+		return;
+	}
+	for (;;) {
+		switch_pending = FALSE;
+		do_all_poles (earliest_resync);
+		if (!switch_pending) {
+			break;
+		}
+		resync_poles ();
+		do_all_poles (end_resync);
+	}
+	do_all_insulators (substep_insulator);
+}
+
+void free_step_state (void)
+{
+	int i;
+
+	for (i = 0; i < STATE_TAPES; i++) {
+		free (state_tape[i]);
+		state_tape[i] = NULL;
+	}
+	state_size = 0;
+}
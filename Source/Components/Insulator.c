@@ -1,206 +1,362 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-/* This module contains the time-step loop and supporting functions for
-LPDW's transient simulation engine, based on H. W. Dommel's IEEE papers.
-Called from the driver and xfmr modules. */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include <time.h>
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_matrix.h>
-#include <gsl/gsl_blas.h>
-#include <gsl/gsl_linalg.h>
-
-#include "../OETypes.h"
-#include "../Parser.h"
-#include "../ReadUtils.h"
-#include "Meter.h"
-#include "../WritePlotFile.h"
-#include "../ChangeTimeStep.h"
-#include "Pole.h"
-#include "Monitor.h"
-#include "Insulator.h"
-
-char insulator_token[] = "insulator";
-
-struct insulator *insulator_head, *insulator_ptr;
-
-void print_insulator_data (struct insulator *ptr)
-{
-	double highest_de;
-	
-	highest_de = ptr->de_pos;
-	if (ptr->de_neg > highest_de) {
-		highest_de = ptr->de_neg;
-	}
-	fprintf (op, "Insulator at pole %d, from %d to %d ",
-		ptr->parent->location, ptr->from, ptr->to);
-	if (ptr->flashed == 1) {
-		fprintf (op, "flashed over at %le seconds\n", ptr->t_flash);
-	} else {
-		fprintf (op, "per-unit SI = %le\n",
-			pow (highest_de / ptr->de_max, 1.0 / ptr->beta));
-	}
-}
-
-/* find the insulator that had the highest severity index */
-
-void insulator_answers_cleanup (struct insulator *ptr)
-{
-	double highest_de;
-	
-	highest_de = ptr->de_pos;
-	if (ptr->de_neg > highest_de) {
-		highest_de = ptr->de_neg;
-	}
-	if (ptr->flashed == 1) {
-		ptr->SI = 1.0;
-		add_y (ptr->parent, ptr->from, ptr->to, -Y_SHORT);
-	} else {
-		ptr->SI = pow (highest_de / ptr->de_max, 1.0 / ptr->beta);
-	}
-	if (fabs (ptr->SI) > fabs (SI)) {
-		SI = ptr->SI;
-	}
-}
-
-/* see if an insulator flashed over - if so, modify the pole y matrix,
-and possibly set flash_halt = TRUE.  This version of the DE model
-"remembers" separate positive and negative "leaders" after polarity
-changes. */
-
-void check_insulator (struct insulator *ptr)
-{
-	struct pole *p;
-	int i, j;
-	double volts, mag, de_inc;
-	
-	if (!ptr->flashed && !dT_switched) { /* haven't flashed over yet - disable during second_dT */
-		p = ptr->parent;
-		i = ptr->from;
-		j = ptr->to;
-		volts = gsl_vector_get (p->voltage, i) - gsl_vector_get (p->voltage, j);
-		mag = fabs (volts) - ptr->vb;
-		if (mag > 0.0) {
-			de_inc = pow (mag, ptr->beta) * dT; /* integrate destructive effect */
-			if (volts >= 0.0) { /* add to either the positive or negative de */
-				ptr->de_pos += de_inc;
-			} else {
-				ptr->de_neg += de_inc;
-			}
-		} else {
-			de_inc = 0.0;
-		}
-		if ((ptr->de_pos >= ptr->de_max) || 
-			(ptr->de_neg >= ptr->de_max)) {
-			ptr->flashed = TRUE; /* flashover for either positive or negative polarity */
-			if (flash_halt_enabled) {
-				flash_halt = TRUE;
-			}
-			ptr->t_flash = t;
-			add_y (p, i, j, Y_SHORT); /* change pole matrix - short out insulator */
-		}
-	}
-}
-
-int init_insulator_list (void)
-{
-	if (((insulator_head = (struct insulator *) malloc (sizeof *insulator_head)) != NULL)) {
-		insulator_head->next = NULL;
-		insulator_ptr = insulator_head;
-		return (0);
-	}
-	if (logfp) fprintf( logfp, "can't initialize insulator list\n");
-	oe_exit (ERR_MALLOC);
-	return (1);
-}
-
-void do_all_insulators (void (*verb) (struct insulator *))
-{
-	insulator_ptr = insulator_head;
-	while (((insulator_ptr = insulator_ptr->next) != NULL)) {
-		verb (insulator_ptr);
-	}
-}
-
-/* read insulator data from file or buffer, set up structs */
-
-int read_insulator (void)
-{
-	int i, j, k;
-	double f_cfo, f_vb, f_de, f_beta;
-	struct insulator *ptr;
-	
-	(void) next_double (&f_cfo);
-	(void) next_double (&f_vb);
-	(void) next_double (&f_beta);
-	(void) next_double (&f_de);
-	if (f_cfo < 0.0) {
-		f_cfo *= -1.0;
-	}
-	f_vb *= f_cfo / 100.0e3;  /* input vb is for CFO = 100 kV, so adjust */
-	f_de *= pow (f_cfo / 100.0e3, f_beta);  /* max de to cause flashover, adjusted from CFO = 100 */
-	(void) read_pairs ();
-	(void) read_poles ();
-	(void) reset_assignments ();
-	while (!next_assignment (&i, &j, &k)) {
-		if (((ptr = (struct insulator *) malloc (sizeof *ptr)) != NULL)) {
-			ptr->cfo = f_cfo;
-			ptr->de_max = f_de;
-			ptr->vb = f_vb;
-			ptr->beta = f_beta;
-			reset_insulator (ptr);
-			move_insulator (ptr, i);
-			ptr->from = j;
-			ptr->to = k;
-			ptr->next = NULL;
-			insulator_ptr->next = ptr;
-			insulator_ptr = ptr;
-		} else {
-			if (logfp) fprintf( logfp, "can't allocate new insulator\n");
-			oe_exit (ERR_MALLOC);
-		}
-	}
-	return (0);
-}
-
-/* reset the insulator "memory" parameters */
-
-void reset_insulator (struct insulator *ptr)
-{
-	ptr->de_pos = 0.0;
-	ptr->de_neg = 0.0;
-	ptr->t_flash = 0.0;
-	ptr->SI = 0.0;
-	ptr->flashed = FALSE;
-}
-
-/* move insulator to a new pole, keep same node connections.  Used when
-simulating strokes to different poles under iteration control */ 
-
-void move_insulator (struct insulator *ptr, int i)
-{
-	ptr->parent = find_pole (i);
-	if (!ptr->parent) oe_exit (ERR_BAD_POLE);
-	ptr->parent->solve = TRUE;
-}
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This module contains the time-step loop and supporting functions for
+LPDW's transient simulation engine, based on H. W. Dommel's IEEE papers.
+Called from the driver and xfmr modules. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+
+#include "../OETypes.h"
+#include "../Parser.h"
+#include "../ReadUtils.h"
+#include "Meter.h"
+#include "../WritePlotFile.h"
+#include "../ChangeTimeStep.h"
+#include "Pole.h"
+#include "Monitor.h"
+#include "Insulator.h"
+
+char insulator_token[] = "insulator";
+
+struct insulator *insulator_head, *insulator_ptr;
+
+void print_insulator_data (struct insulator *ptr)
+{
+	double highest_de;
+	
+	highest_de = ptr->de_pos;
+	if (ptr->de_neg > highest_de) {
+		highest_de = ptr->de_neg;
+	}
+	fprintf (op, "Insulator at pole %d, from %d to %d ",
+		ptr->parent->location, ptr->from, ptr->to);
+	if (ptr->flashed == 1) {
+		fprintf (op, "flashed over at %le seconds\n", ptr->t_flash);
+	} else {
+		fprintf (op, "per-unit SI = %le\n",
+			pow (highest_de / ptr->de_max, 1.0 / ptr->beta));
+	}
+}
+
+/* find the insulator that had the highest severity index */
+
+void insulator_answers_cleanup (struct insulator *ptr)
+{
+	double highest_de;
+	
+	highest_de = ptr->de_pos;
+	if (ptr->de_neg > highest_de) {
+		highest_de = ptr->de_neg;
+	}
+	if (ptr->flashed == 1) {
+		ptr->SI = 1.0;
+		add_y (ptr->parent, ptr->from, ptr->to, -Y_SHORT);
+	} else {
+		ptr->SI = pow (highest_de / ptr->de_max, 1.0 / ptr->beta);
+	}
+	if (fabs (ptr->SI) > fabs (SI)) {
+		SI = ptr->SI;
+	}
+}
+
+/* see if an insulator flashed over - if so, modify the pole y matrix,
+and possibly set flash_halt = TRUE.  This version of the DE model
+"remembers" separate positive and negative "leaders" after polarity
+changes. */
+
+/* With substep_switching, the destructive effect of one polarity (sign = 1
+or -1) over the step integrates by trapezoids, starting or stopping where the
+straight line between the two step voltages crosses vb. */
+
+static double substep_de (struct insulator *ptr, double sign, double volts)
+{
+	double past = sign * ptr->v_past;
+	double now = sign * volts;
+
+	if (past > ptr->vb && now > ptr->vb) {
+		return 0.5 * dT * (pow (past - ptr->vb, ptr->beta) + pow (now - ptr->vb, ptr->beta));
+	} else if (now > ptr->vb) {
+		return 0.5 * (t - crossing_time (past, now, ptr->vb)) * pow (now - ptr->vb, ptr->beta);
+	} else if (past > ptr->vb) {
+		return 0.5 * (crossing_time (past, now, ptr->vb) - (t - dT)) * pow (past - ptr->vb, ptr->beta);
+	}
+	return 0.0;
+}
+
+/* The insulator flashed over during this step, when its de_pos or de_neg
+went from the old values to ptr->de_pos or ptr->de_neg */
+
+static void flash_insulator (struct insulator *ptr, double de_pos, double de_neg)
+{
+	ptr->flashed = TRUE; /* flashover for either positive or negative polarity */
+	if (flash_halt_enabled) {
+		flash_halt = TRUE;
+	}
+	ptr->t_flash = t;
+	if (substep_switching) {  /* when the de reached de_max */
+		if (ptr->de_pos >= ptr->de_max) {
+			ptr->t_flash = crossing_time (de_pos, ptr->de_pos, ptr->de_max);
+		} else {
+			ptr->t_flash = crossing_time (de_neg, ptr->de_neg, ptr->de_max);
+		}
+		(void) switch_within_step (ptr->parent, ptr->t_flash);
+	}
+	add_y (ptr->parent, ptr->from, ptr->to, Y_SHORT); /* change pole matrix - short out insulator */
+	TriggerPlotCapture (ptr->t_flash);
+}
+
+void check_insulator (struct insulator *ptr)
+{
+	struct pole *p;
+	int i, j;
+	double volts, mag, de_inc, de_pos, de_neg;
+	
+	if (!ptr->flashed && !dT_switched) { /* haven't flashed over yet - disable during second_dT */
+		p = ptr->parent;
+		i = ptr->from;
+		j = ptr->to;
+		volts = gsl_vector_get (p->voltage, i) - gsl_vector_get (p->voltage, j);
+		mag = fabs (volts) - ptr->vb;
+		de_pos = ptr->de_pos;
+		de_neg = ptr->de_neg;
+		if (substep_switching) {
+			ptr->de_pos += substep_de (ptr, 1.0, volts);
+			ptr->de_neg += substep_de (ptr, -1.0, volts);
+			ptr->v_past = volts;
+		} else if (mag > 0.0) {
+			de_inc = pow (mag, ptr->beta) * dT; /* integrate destructive effect */
+			if (volts >= 0.0) { /* add to either the positive or negative de */
+				ptr->de_pos += de_inc;
+			} else {
+				ptr->de_neg += de_inc;
+			}
+		} else {
+			de_inc = 0.0;
+		}
+		if ((ptr->de_pos >= ptr->de_max) || 
+			(ptr->de_neg >= ptr->de_max)) {
+			flash_insulator (ptr, de_pos, de_neg);
+		}
+	}
+}
+
+/* replace each x[i] with the destructive-effect rate x[i]^beta, or 0 where
+x[i] <= 0.  Integer and half-integer exponents up to DE_MAX_POWER use one
+sqrt and repeated products, within 4e-16 relative of pow; other exponents
+call pow. */
+
+void de_rates (double beta, int n, double *x)
+{
+	int i, j, k;
+	double xi, p;
+
+	k = (int) beta;
+	if (beta > 0.0 && beta <= DE_MAX_POWER && 2.0 * beta == floor (2.0 * beta)) {
+		for (i = 0; i < n; i++) {
+			xi = x[i] > 0.0 ? x[i] : 0.0;
+			p = beta > k ? sqrt (xi) : 1.0;
+			for (j = 0; j < k; j++) {
+				p *= xi;
+			}
+			x[i] = p;
+		}
+	} else {
+		for (i = 0; i < n; i++) {
+			x[i] = x[i] > 0.0 ? pow (x[i], beta) : 0.0;
+		}
+	}
+}
+
+/* scratch for check_all_insulators, one entry per unflashed insulator */
+
+static struct insulator **de_insulators = NULL;
+static double *de_volts = NULL;
+static double *de_x = NULL;
+static int de_size = 0;
+
+static void grow_de_scratch (int n)
+{
+	if (n <= de_size) {
+		return;
+	}
+	de_size = n > 2 * de_size ? n : 2 * de_size;
+	de_insulators = (struct insulator **) realloc (de_insulators, de_size * sizeof *de_insulators);
+	de_volts = (double *) realloc (de_volts, de_size * sizeof *de_volts);
+	de_x = (double *) realloc (de_x, de_size * sizeof *de_x);
+	if (!de_insulators || !de_volts || !de_x) {
+		if (logfp) fprintf( logfp, "can't allocate insulator scratch\n");
+		oe_exit (ERR_MALLOC);
+	}
+}
+
+void free_insulator_scratch (void)
+{
+	free (de_insulators);
+	free (de_volts);
+	free (de_x);
+	de_insulators = NULL;
+	de_volts = NULL;
+	de_x = NULL;
+	de_size = 0;
+}
+
+/* check_insulator for the whole list: gather |v| - vb of the unflashed
+insulators, evaluate the rates for each run of equal beta in one call,
+then add each increment to de_pos or de_neg without branching on the
+polarity */
+
+void check_all_insulators (void)
+{
+	struct insulator *ptr;
+	struct pole *p;
+	double volts, inc, pos, de_pos, de_neg;
+	int i, j, n;
+
+	if (substep_switching) {
+		do_all_insulators (check_insulator);
+		return;
+	}
+	if (dT_switched) {  /* disabled during second_dT */
+		return;
+	}
+	n = 0;
+	ptr = insulator_head;
+	while ((ptr = ptr->next) != NULL) {
+		if (ptr->flashed) {
+			continue;
+		}
+		grow_de_scratch (n + 1);
+		p = ptr->parent;
+		volts = gsl_vector_get (p->voltage, ptr->from) - gsl_vector_get (p->voltage, ptr->to);
+		de_insulators[n] = ptr;
+		de_volts[n] = volts;
+		de_x[n] = fabs (volts) - ptr->vb;
+		++n;
+	}
+	for (i = 0; i < n; i = j) {
+		for (j = i + 1; j < n && de_insulators[j]->beta == de_insulators[i]->beta; j++) {
+		}
+		de_rates (de_insulators[i]->beta, j - i, de_x + i);
+	}
+	for (i = 0; i < n; i++) {
+		ptr = de_insulators[i];
+		inc = de_x[i] * dT;
+		pos = de_volts[i] >= 0.0 ? 1.0 : 0.0;
+		de_pos = ptr->de_pos;
+		de_neg = ptr->de_neg;
+		ptr->de_pos += inc * pos;
+		ptr->de_neg += inc * (1.0 - pos);
+		if ((ptr->de_pos >= ptr->de_max) || 
+			(ptr->de_neg >= ptr->de_max)) {
+			flash_insulator (ptr, de_pos, de_neg);
+		}
+	}
+}
+
+int init_insulator_list (void)
+{
+	if (((insulator_head = (struct insulator *) malloc (sizeof *insulator_head)) != NULL)) {
+		insulator_head->next = NULL;
+		insulator_ptr = insulator_head;
+		return (0);
+	}
+	if (logfp) fprintf( logfp, "can't initialize insulator list\n");
+	oe_exit (ERR_MALLOC);
+	return (1);
+}
+
+void do_all_insulators (void (*verb) (struct insulator *))
+{
+	insulator_ptr = insulator_head;
+	while (((insulator_ptr = insulator_ptr->next) != NULL)) {
+		verb (insulator_ptr);
+	}
+}
+
+/* read insulator data from file or buffer, set up structs */
+
+int read_insulator (void)
+{
+	int i, j, k;
+	double f_cfo, f_vb, f_de, f_beta;
+	struct insulator *ptr;
+	
+	(void) next_double (&f_cfo);
+	(void) next_double (&f_vb);
+	(void) next_double (&f_beta);
+	(void) next_double (&f_de);
+	if (f_cfo < 0.0) {
+		f_cfo *= -1.0;
+	}
+	f_vb *= f_cfo / 100.0e3;  /* input vb is for CFO = 100 kV, so adjust */
+	f_de *= pow (f_cfo / 100.0e3, f_beta);  /* max de to cause flashover, adjusted from CFO = 100 */
+	(void) read_pairs ();
+	(void) read_poles ();
+	(void) reset_assignments ();
+	while (!next_assignment (&i, &j, &k)) {
+		if (((ptr = (struct insulator *) malloc (sizeof *ptr)) != NULL)) {
+			ptr->cfo = f_cfo;
+			ptr->de_max = f_de;
+			ptr->vb = f_vb;
+			ptr->beta = f_beta;
+			reset_insulator (ptr);
+			move_insulator (ptr, i);
+			ptr->from = j;
+			ptr->to = k;
+			ptr->next = NULL;
+			insulator_ptr->next = ptr;
+			insulator_ptr = ptr;
+		} else {
+			if (logfp) fprintf( logfp, "can't allocate new insulator\n");
+			oe_exit (ERR_MALLOC);
+		}
+	}
+	return (0);
+}
+
+/* reset the insulator "memory" parameters */
+
+void reset_insulator (struct insulator *ptr)
+{
+	ptr->de_pos = 0.0;
+	ptr->de_neg = 0.0;
+	ptr->v_past = 0.0;
+	ptr->t_flash = 0.0;
+	ptr->SI = 0.0;
+	ptr->flashed = FALSE;
+}
+
+/* move insulator to a new pole, keep same node connections.  Used when
+simulating strokes to different poles under iteration control */ 
+
+void move_insulator (struct insulator *ptr, int i)
+{
+	ptr->parent = find_pole (i);
+	if (!ptr->parent) oe_exit (ERR_BAD_POLE);
+	ptr->parent->solve = TRUE;
+}
@@ -1,317 +1,538 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <math.h>
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_matrix.h>
-#include <gsl/gsl_blas.h>
-#include <gsl/gsl_linalg.h>
-
-#include "../OETypes.h"
-#include "../Parser.h"
-#include "../ReadUtils.h"
-#include "Meter.h"
-#include "../WritePlotFile.h"
-#include "../ChangeTimeStep.h"
-#include "Pole.h"
-#include "Monitor.h"
-#include "LPM.h"
-
-#define SI_FOR_FO_STARTED  0.9999
-#define SCALE_TOLERANCE  0.0001
-#define MAX_SCALE     100.0
-#define MIN_SCALE      0.01
-
-static double lpm_si_counter = 0.0;  /* for progress feedback to SDW */
-
-char lpm_token[] = "lpm";
-
-struct lpm *lpm_head, *lpm_ptr;
-
-int init_lpm_list (void)
-{
-    if ((lpm_head = (struct lpm *) malloc (sizeof *lpm_head))) {
-        lpm_head->next = NULL;
-        lpm_head->pts = NULL;
-        lpm_ptr = lpm_head;
-        return (0);
-    }
-    if (logfp) fprintf (logfp, "can't initialize lpm list\n");
-    oe_exit (ERR_MALLOC);
-    return (1);
-}
-
-void do_all_lpms (void (*verb) (struct lpm *))
-{
-    lpm_ptr = lpm_head;
-    while ((lpm_ptr = lpm_ptr->next)) {
-        verb (lpm_ptr);
-    }
-}
-
-/*  &&&&  lpm functions  */
-
-int read_lpm (void)
-{
-    int i, j, k;
-    double f_cfo, f_e0, f_k;
-    int flash_mode = LPM_NOT_FLASHED;
-    struct lpm *ptr;
-
-    (void) next_double (&f_cfo);
-    (void) next_double (&f_e0);
-    (void) next_double (&f_k);
-    if (f_cfo < 0.0) {
-        f_cfo *= -1.0;
-        flash_mode = LPM_DISABLE_FLASH;
-    }
-    (void) read_pairs ();
-    (void) read_poles ();
-    (void) reset_assignments ();
-    while (!next_assignment (&i, &j, &k)) {
-        if ((ptr = (struct lpm *) malloc (sizeof *ptr))) {
-            ptr->cfo = f_cfo;
-            ptr->e0 = f_e0;
-            ptr->k = f_k;
-            ptr->pts = NULL;
-            ptr->flash_mode = flash_mode;
-            reset_lpm (ptr);
-            move_lpm (ptr, i);
-            ptr->from = j;
-            ptr->to = k;
-            ptr->next = NULL;
-            lpm_ptr->next = ptr;
-            lpm_ptr = ptr;
-        } else {
-            if (logfp) fprintf (logfp, "can't allocate new lpm\n");
-            oe_exit (ERR_MALLOC);
-        }
-    }
-    return (0);
-}
-
-void reset_lpm (struct lpm *ptr)
-{
-    int nsteps = (int) (Tmax / dT) + 2;
-	int i;
-
-    ptr->d = ptr->cfo / 560.0e3;
-    ptr->xpos = ptr->d;
-    ptr->xneg = ptr->d;
-    ptr->t_flash = 0.0;
-    ptr->vpk_pos = 0.0;
-    ptr->vpk_neg = 0.0;
-	ptr->SI = 0.0;
-    if (ptr->flash_mode != LPM_DISABLE_FLASH) {
-        ptr->flash_mode = LPM_NOT_FLASHED;
-    }
-    if (ptr->pts) {
-        free (ptr->pts);
-		ptr->pts = NULL;
-    }
-    ptr->pts = (float *) malloc (nsteps * sizeof (float));
-	for (i = 0; i < nsteps; i++) {
-		ptr->pts[i] = 0.0;
-	}
-	lpm_si_counter = 0.0;
-}
-
-void move_lpm (struct lpm *ptr, int i)
-{
-    ptr->parent = find_pole (i);
-	if (!ptr->parent) oe_exit (ERR_BAD_POLE);
-    ptr->parent->solve = TRUE;
-}
-
-static int lpm_flashes_over (struct lpm *ptr, double scale, int nsteps)
-{
-    int i, sign=0;
-    double volts, ds, ds2;
-    double x=1.0, dx;
-    double xpos = ptr->d;
-    double xneg = ptr->d;
-
-    for (i = 0; i < nsteps ; i++) {
-        volts = scale * ptr->pts[i];
-        if (volts > 0.0) {
-            sign = 1;
-            x = xpos;
-        } else if (volts < 0.0) {
-            sign = -1;
-            x = xneg;
-        }
-        volts = fabs (volts);
-        ds = volts * ptr->k * dT;
-        ds2 = ds * volts / x;
-        ds *= ptr->e0;
-        dx = ds2 - ds;
-        if (sign > 0 && dx > 0.0) {
-            xpos -= dx;
-        } else if (dx > 0.0) {
-            xneg -= dx;
-        }
-        if (xpos <= 0.0 || xneg <= 0.0) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-double calculate_lpm_si (struct lpm *ptr)
-{
-    int nsteps = (int) (Tmax / dT) + 1;
-    double scale_low, scale_high, scale_mid;
-
-    if (ptr->flash_mode == LPM_FLASHED) {
-        return 1.0;
-    }
-	if (ptr->vpk_pos <= 0.0 && ptr->vpk_neg <= 0.0) {
-		return 0.0;
-	}
-    // first bracket the root
-    scale_low = scale_high = 1.0;
-    while (scale_low > MIN_SCALE && lpm_flashes_over (ptr, scale_low, nsteps)) {
-        scale_low *= 0.5;
-    }
-    while (scale_high < MAX_SCALE && !lpm_flashes_over (ptr, scale_high, nsteps)) {
-        scale_high *= 2.0;
-    }
-    // now find the SI using bisection
-    while (scale_high - scale_low > SCALE_TOLERANCE) {
-        scale_mid = 0.5 * (scale_high + scale_low);
-        if (lpm_flashes_over (ptr, scale_mid, nsteps)) {
-            scale_high = scale_mid;
-        } else {
-            scale_low = scale_mid;
-        }
-    }
-    scale_mid = 0.5 * (scale_high + scale_low);
-    return 1.0 / scale_mid;
-}
-
-double estimate_lpm_si (struct lpm *ptr)
-{
-    double si_pos = 0.0;
-    double si_neg = 0.0;
-
-    if (ptr->flash_mode == LPM_FLASHED) {
-        return 1.0;
-    }
-    if (ptr->xpos < ptr->d) {
-        si_pos = SI_FOR_FO_STARTED;
-    } else if (ptr->vpk_pos > 0.0) {
-        si_pos = ptr->vpk_pos / ptr->cfo;
-    }
-    if (ptr->xneg < ptr->d) {
-        si_neg = SI_FOR_FO_STARTED;
-    } else if (ptr->vpk_neg > 0.0) {
-        si_neg = ptr->vpk_neg / ptr->cfo;
-    }
-    return si_pos > si_neg ? si_pos : si_neg;
-}
-
-void print_lpm_data (struct lpm *ptr)
-{
-    fprintf (op, "insulator at pole %d, from %d to %d ",
-        ptr->parent->location, ptr->from, ptr->to);
-    if (ptr->flash_mode == LPM_FLASHED) {
-        fprintf (op, "flashed over at %le seconds\n", ptr->t_flash);
-    } else {
-        fprintf (op, "per-unit SI = %le\n", calculate_lpm_si (ptr));
-    }
-}
-
-void lpm_answers_cleanup (struct lpm *ptr)
-{
-    if (ptr->flash_mode == LPM_FLASHED) {
-        ptr->SI = 1.0;
-        add_y (ptr->parent, ptr->from, ptr->to, -Y_SHORT);
-    } else if (want_si_calculation) {  /* didn't flashover, or was disabled */
-        ptr->SI = calculate_lpm_si (ptr);
-    } else {
-        ptr->SI = estimate_lpm_si (ptr);
-    }
-    if (ptr->SI > SI) {
-        SI = ptr->SI;
-    }
-}
-
-void check_lpm (struct lpm *ptr)
-{
-    struct pole *p;
-    int i, j, sign;
-    double volts, ds, ds2;
-    double x, dx;
-
-	if (dT_switched) return;  /* disable flashover, and pts writing, after switching dT */
-	/* CAUTION - pts would be overwritten unless it's resized after changing dT */
-    if (ptr->flash_mode != LPM_FLASHED) {
-        p = ptr->parent;
-        i = ptr->from;
-        j = ptr->to;
-        volts = gsl_vector_get (p->voltage, i) - gsl_vector_get (p->voltage, j);
-        ptr->pts[step] = (float) volts;
-        if (volts > 0.0) {
-            sign = 1;
-            x = ptr->xpos;
-        } else if (volts < 0.0) {
-            sign = -1;
-            x = ptr->xneg;
-        } else {  // no voltage means no leader propagation
-            return;
-        }
-        volts = fabs (volts);
-        ds = volts * ptr->k * dT;
-        ds2 = ds * volts / x;
-        ds *= ptr->e0;
-        dx = ds2 - ds;
-        if (sign > 0) {
-            if (dx > 0.0) {  // leader moves only when pushed the right direction
-                ptr->xpos -= dx;
-            }
-            if (volts > ptr->vpk_pos) {
-                ptr->vpk_pos = volts;
-            }
-        } else {
-            if (dx > 0.0) {
-                ptr->xneg -= dx;
-            }
-            if (volts > ptr->vpk_neg) {
-                ptr->vpk_neg = volts;
-            }
-        }
-        if (ptr->flash_mode == LPM_DISABLE_FLASH) { // need to keep waveshape, vpk_pos, and vpk_neg
-            return;
-        }
-        if ((ptr->xpos <= 0.0) ||
-            (ptr->xneg <= 0.0)) {
-            ptr->flash_mode = LPM_FLASHED;
-            if (flash_halt_enabled) {
-                flash_halt = TRUE;
-            }
-            ptr->t_flash = t;
-            add_y (p, i, j, Y_SHORT);
-        }
-    }
-}
-
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+
+#include "../OETypes.h"
+#include "../Parser.h"
+#include "../ReadUtils.h"
+#include "Meter.h"
+#include "../WritePlotFile.h"
+#include "../ChangeTimeStep.h"
+#include "Pole.h"
+#include "Monitor.h"
+#include "LPM.h"
+
+#define SI_FOR_FO_STARTED  0.9999
+#define SCALE_TOLERANCE  0.0001
+#define MAX_SCALE     100.0
+#define MIN_SCALE      0.01
+#define DSI_STEP       0.001  /* waveform perturbation, per unit of its peak */
+#define DSI_TOLERANCE  1.0e-9
+#ifndef LPM_LANES
+#define LPM_LANES      8   /* trial scales per pass over the waveform */
+#endif
+#define LPM_SETTLED    0.999  /* margin on |v| <= e0 x against rounding */
+#define LPM_FIRST_SIZE 1024   /* first allocation of an lpm waveform, in samples */
+
+static double lpm_si_counter = 0.0;  /* for progress feedback to SDW */
+
+char lpm_token[] = "lpm";
+
+struct lpm *lpm_head, *lpm_ptr;
+
+int init_lpm_list (void)
+{
+    if ((lpm_head = (struct lpm *) malloc (sizeof *lpm_head))) {
+        lpm_head->next = NULL;
+        lpm_head->pts = NULL;
+        init_wave_code (&lpm_head->dpts, wave_quantum);
+        lpm_head->pts_size = 0;
+        lpm_ptr = lpm_head;
+        return (0);
+    }
+    if (logfp) fprintf (logfp, "can't initialize lpm list\n");
+    oe_exit (ERR_MALLOC);
+    return (1);
+}
+
+void do_all_lpms (void (*verb) (struct lpm *))
+{
+    lpm_ptr = lpm_head;
+    while ((lpm_ptr = lpm_ptr->next)) {
+        verb (lpm_ptr);
+    }
+}
+
+/*  &&&&  lpm functions  */
+
+int read_lpm (void)
+{
+    int i, j, k;
+    double f_cfo, f_e0, f_k;
+    int flash_mode = LPM_NOT_FLASHED;
+    struct lpm *ptr;
+
+    (void) next_double (&f_cfo);
+    (void) next_double (&f_e0);
+    (void) next_double (&f_k);
+    if (f_cfo < 0.0) {
+        f_cfo *= -1.0;
+        flash_mode = LPM_DISABLE_FLASH;
+    }
+    (void) read_pairs ();
+    (void) read_poles ();
+    (void) reset_assignments ();
+    while (!next_assignment (&i, &j, &k)) {
+        if ((ptr = (struct lpm *) malloc (sizeof *ptr))) {
+            ptr->cfo = f_cfo;
+            ptr->e0 = f_e0;
+            ptr->k = f_k;
+            ptr->pts = NULL;
+            init_wave_code (&ptr->dpts, wave_quantum);
+            ptr->pts_size = 0;
+            ptr->flash_mode = flash_mode;
+            reset_lpm (ptr);
+            move_lpm (ptr, i);
+            ptr->from = j;
+            ptr->to = k;
+            ptr->next = NULL;
+            lpm_ptr->next = ptr;
+            lpm_ptr = ptr;
+        } else {
+            if (logfp) fprintf (logfp, "can't allocate new lpm\n");
+            oe_exit (ERR_MALLOC);
+        }
+    }
+    return (0);
+}
+
+/* The waveform buffers stay with the LPM from one run to the next, and
+grow only when a run keeps more samples than any run before it. */
+
+void reset_lpm (struct lpm *ptr)
+{
+    ptr->d = ptr->cfo / 560.0e3;
+    ptr->xpos = ptr->d;
+    ptr->xneg = ptr->d;
+    ptr->v_quiet = ptr->e0 * ptr->d / MAX_SCALE;
+    ptr->t_flash = 0.0;
+    ptr->vpk_pos = 0.0;
+    ptr->vpk_neg = 0.0;
+	ptr->SI = 0.0;
+    if (ptr->flash_mode != LPM_DISABLE_FLASH) {
+        ptr->flash_mode = LPM_NOT_FLASHED;
+    }
+    ptr->npts = 0;
+    reset_wave_code (&ptr->dpts);
+	lpm_si_counter = 0.0;
+}
+
+void free_lpm (struct lpm *ptr)
+{
+    free (ptr->pts);
+    free_wave_code (&ptr->dpts);
+    free (ptr);
+}
+
+/* Only the samples that could move a leader at some scale up to MAX_SCALE
+are kept: at or below v_quiet, MAX_SCALE |v| <= e0 d, which can't start a
+leader.  Dropping them changes nothing in the SI search except for a leader
+that is already under way, where they would have added at most
+k dT MAX_SCALE^2 v_quiet^2 / x per step.  Returns the index in pts (and
+dpts) that volts will take, growing the buffers if needed, or -1 if volts
+is not kept. */
+
+int next_lpm_sample (struct lpm *ptr, double volts)
+{
+    int nsteps = (int) (Tmax / dT) + 2;
+    int size;
+
+    if (fabs (volts) <= ptr->v_quiet) {
+        return -1;
+    }
+    if (ptr->npts >= ptr->pts_size) {
+        size = ptr->pts_size > 0 ? 2 * ptr->pts_size : LPM_FIRST_SIZE;
+        if (size > nsteps) {
+            size = nsteps;
+        }
+        if (size <= ptr->npts) {
+            size = ptr->npts + 1;
+        }
+        if (!(ptr->pts = (float *) realloc (ptr->pts, size * sizeof (float)))) {
+            if (logfp) fprintf (logfp, "can't allocate lpm waveform\n");
+            oe_exit (ERR_MALLOC);
+        }
+        ptr->pts_size = size;
+    }
+    return ptr->npts;
+}
+
+void move_lpm (struct lpm *ptr, int i)
+{
+    ptr->parent = find_pole (i);
+	if (!ptr->parent) oe_exit (ERR_BAD_POLE);
+    ptr->parent->solve = TRUE;
+}
+
+/* peak of |pts| from each step to the end, so that a pass can stop once the
+rest of the waveform is too weak to push any leader: the leader moves only
+while |v| > e0 x, and x never grows */
+
+static float *lpm_tail = NULL;
+static int lpm_tail_size = 0;
+
+static void find_lpm_tail (struct lpm *ptr, int nsteps)
+{
+    int i;
+    float peak = 0.0;
+
+    if (nsteps > lpm_tail_size) {
+        free (lpm_tail);
+        if (!(lpm_tail = (float *) malloc (nsteps * sizeof (float)))) {
+            if (logfp) fprintf (logfp, "can't allocate lpm tail\n");
+            oe_exit (ERR_MALLOC);
+        }
+        lpm_tail_size = nsteps;
+    }
+    for (i = nsteps - 1; i >= 0; i--) {
+        if (fabs (ptr->pts[i]) > peak) {
+            peak = (float) fabs (ptr->pts[i]);
+        }
+        lpm_tail[i] = peak;
+    }
+}
+
+void free_lpm_scratch (void)
+{
+    free (lpm_tail);
+    lpm_tail = NULL;
+    lpm_tail_size = 0;
+}
+
+/* One pass over the waveform for n <= LPM_LANES trial scale factors at
+once, in ascending order.  The polarity, and so the leader being pushed, is
+the same in every lane, so the inner loop has no branches.  As in the
+bisection, flashover is taken to be monotonic in the scale: once a lane
+flashes, the lanes above it are dropped from the pass.  The pass ends early
+when the tail of the waveform can no longer move any leader.  Returns the
+index of the lowest scale that flashes the gap over, or n if none does.
+find_lpm_tail must have been called for the waveform. */
+
+static int lpm_first_flash (struct lpm *ptr, const double *scale, int n, int nsteps)
+{
+    int i, l, sign = 0;
+    double pt, volts, ds, ds2, dx;
+    double xpos[LPM_LANES], xneg[LPM_LANES], *x;
+    double k = ptr->k, e0 = ptr->e0;
+
+    for (l = 0; l < n; l++) {
+        xpos[l] = ptr->d;
+        xneg[l] = ptr->d;
+    }
+    x = xneg;
+    for (i = 0; i < nsteps && n > 0; i++) {
+        pt = ptr->pts[i];
+        if (pt > 0.0) {
+            sign = 1;
+            x = xpos;
+        } else if (pt < 0.0) {
+            sign = -1;
+            x = xneg;
+        }
+        if (sign == 0) {
+            continue;  /* no voltage yet, so no leader */
+        }
+        pt = fabs (pt);
+        for (l = 0; l < n; l++) {
+            volts = scale[l] * pt;
+            ds = volts * k * dT;
+            ds2 = ds * volts / x[l];
+            ds *= e0;
+            dx = ds2 - ds;
+            x[l] -= 0.5 * (dx + fabs (dx));  /* dx if positive, else 0 */
+        }
+        for (l = 0; l < n; l++) {
+            if (x[l] <= 0.0) {
+                n = l;
+                break;
+            }
+        }
+        if (n > 0 && scale[n - 1] * lpm_tail[i] <= LPM_SETTLED * e0 * fmin (xpos[n - 1], xneg[n - 1])) {
+            for (l = 0; l < n - 1; l++) {  /* the top lane has settled, check the others */
+                if (scale[l] * lpm_tail[i] > LPM_SETTLED * e0 * fmin (xpos[l], xneg[l])) {
+                    break;
+                }
+            }
+            if (l == n - 1) {
+                return n;
+            }
+        }
+    }
+    return n;
+}
+
+/* find the SI as 1 / the waveform scale factor that just causes flashover.
+Each pass tries LPM_LANES scales: doublings or halvings of the scale while
+bracketing the root, then evenly spaced points that cut the bracket into
+LPM_LANES + 1 pieces.  The search stops when the scale is within tolerance,
+or when SI - 1 is known to within the fraction precision of itself (0 to
+always go to tolerance). */
+
+static double lpm_si_by_bisection (struct lpm *ptr, int nsteps, double tolerance,
+    double precision)
+{
+    double scale_low, scale_high, next, step;
+    double scale[LPM_LANES];
+    int n, f, down;
+
+    find_lpm_tail (ptr, nsteps);
+    // first bracket the root, going up from 1
+    scale_low = scale_high = next = 1.0;
+    do {
+        for (n = 0; n < LPM_LANES; n++) {
+            scale[n] = next;
+            next *= 2.0;
+            if (scale[n] >= MAX_SCALE) {
+                ++n;
+                break;
+            }
+        }
+        f = lpm_first_flash (ptr, scale, n, nsteps);
+        if (f > 0) {
+            scale_low = scale[f - 1];
+        }
+        scale_high = scale[f < n ? f : n - 1];
+    } while (f == n && scale_high < MAX_SCALE);
+    // or down from 1 if that flashed
+    down = scale_high == 1.0;
+    next = 0.5;
+    while (down) {
+        for (n = 0; n < LPM_LANES; n++) {  /* fill in descending order */
+            scale[n] = next;
+            next *= 0.5;
+            if (scale[n] <= MIN_SCALE) {
+                ++n;
+                break;
+            }
+        }
+        for (f = 0; f < n / 2; f++) {
+            step = scale[f];
+            scale[f] = scale[n - 1 - f];
+            scale[n - 1 - f] = step;
+        }
+        f = lpm_first_flash (ptr, scale, n, nsteps);
+        if (f > 0) {
+            scale_low = scale[f - 1];
+            if (f < n) {
+                scale_high = scale[f];
+            }
+            down = FALSE;
+        } else {
+            scale_low = scale_high = scale[0];
+            down = scale[0] > MIN_SCALE;
+        }
+    }
+    // now narrow the bracket, by a factor LPM_LANES + 1 per pass
+    while (scale_high - scale_low > tolerance &&
+        1.0 / scale_low - 1.0 / scale_high > precision * fabs (1.0 - 1.0 / scale_low)) {
+        step = (scale_high - scale_low) / (LPM_LANES + 1);
+        for (n = 0; n < LPM_LANES; n++) {
+            scale[n] = scale_low + (n + 1) * step;
+        }
+        f = lpm_first_flash (ptr, scale, LPM_LANES, nsteps);
+        if (f < LPM_LANES) {
+            scale_high = scale[f];
+        }
+        if (f > 0) {
+            scale_low = scale[f - 1];
+        }
+    }
+    return 1.0 / (0.5 * (scale_high + scale_low));
+}
+
+double calculate_lpm_si (struct lpm *ptr, double precision)
+{
+    int nsteps = ptr->npts;
+
+    if (ptr->flash_mode == LPM_FLASHED) {
+        return 1.0;
+    }
+	if (ptr->vpk_pos <= 0.0 && ptr->vpk_neg <= 0.0) {
+		return 0.0;
+	}
+    return lpm_si_by_bisection (ptr, nsteps, SCALE_TOLERANCE, precision);
+}
+
+/* derivative of the SI with respect to the stroke peak, by central
+differences along the tangent waveform in dpts, which is decoded in
+step with pts on each pass */
+
+double calculate_lpm_dsi (struct lpm *ptr)
+{
+    int nsteps = ptr->npts;
+    int i;
+    double vmax = 0.0, dvmax = 0.0, eps, si_plus, si_minus;
+    float *pts, *perturbed;
+    struct wave_decoder dec;
+
+    if (ptr->flash_mode == LPM_FLASHED || ptr->dpts.n < nsteps) {
+        return 0.0;
+    }
+    start_wave_decoder (&dec, &ptr->dpts);
+    for (i = 0; i < nsteps; i++) {
+        if (fabs (ptr->pts[i]) > vmax) vmax = fabs (ptr->pts[i]);
+        dvmax = fmax (dvmax, fabs (next_wave_value (&dec)));
+    }
+    if (vmax <= 0.0 || dvmax <= 0.0) {
+        return 0.0;
+    }
+    eps = DSI_STEP * vmax / dvmax;
+    if (!(perturbed = (float *) malloc (nsteps * sizeof (float)))) {
+        if (logfp) fprintf (logfp, "can't allocate lpm sensitivity\n");
+        oe_exit (ERR_MALLOC);
+    }
+    pts = ptr->pts;
+    ptr->pts = perturbed;
+    start_wave_decoder (&dec, &ptr->dpts);
+    for (i = 0; i < nsteps; i++) {
+        perturbed[i] = (float) (pts[i] + eps * next_wave_value (&dec));
+    }
+    si_plus = lpm_si_by_bisection (ptr, nsteps, DSI_TOLERANCE, 0.0);
+    start_wave_decoder (&dec, &ptr->dpts);
+    for (i = 0; i < nsteps; i++) {
+        perturbed[i] = (float) (pts[i] - eps * next_wave_value (&dec));
+    }
+    si_minus = lpm_si_by_bisection (ptr, nsteps, DSI_TOLERANCE, 0.0);
+    ptr->pts = pts;
+    free (perturbed);
+    return (si_plus - si_minus) / (2.0 * eps);
+}
+
+double estimate_lpm_si (struct lpm *ptr)
+{
+    double si_pos = 0.0;
+    double si_neg = 0.0;
+
+    if (ptr->flash_mode == LPM_FLASHED) {
+        return 1.0;
+    }
+    if (ptr->xpos < ptr->d) {
+        si_pos = SI_FOR_FO_STARTED;
+    } else if (ptr->vpk_pos > 0.0) {
+        si_pos = ptr->vpk_pos / ptr->cfo;
+    }
+    if (ptr->xneg < ptr->d) {
+        si_neg = SI_FOR_FO_STARTED;
+    } else if (ptr->vpk_neg > 0.0) {
+        si_neg = ptr->vpk_neg / ptr->cfo;
+    }
+    return si_pos > si_neg ? si_pos : si_neg;
+}
+
+void print_lpm_data (struct lpm *ptr)
+{
+    fprintf (op, "insulator at pole %d, from %d to %d ",
+        ptr->parent->location, ptr->from, ptr->to);
+    if (ptr->flash_mode == LPM_FLASHED) {
+        fprintf (op, "flashed over at %le seconds\n", ptr->t_flash);
+    } else {
+        fprintf (op, "per-unit SI = %le\n", calculate_lpm_si (ptr, 0.0));
+    }
+}
+
+void lpm_answers_cleanup (struct lpm *ptr)
+{
+    if (ptr->flash_mode == LPM_FLASHED) {
+        ptr->SI = 1.0;
+        add_y (ptr->parent, ptr->from, ptr->to, -Y_SHORT);
+    } else if (want_si_calculation) {  /* didn't flashover, or was disabled */
+        ptr->SI = calculate_lpm_si (ptr, si_precision);
+    } else {
+        ptr->SI = estimate_lpm_si (ptr);
+    }
+    if (ptr->SI > SI) {
+        SI = ptr->SI;
+    }
+}
+
+void check_lpm (struct lpm *ptr)
+{
+    struct pole *p;
+    int i, j, sign;
+    double volts, ds, ds2;
+    double x, dx;
+
+	if (dT_switched) return;  /* disable flashover, and pts writing, after switching dT */
+	/* CAUTION - pts would be overwritten unless it's resized after changing dT */
+    if (ptr->flash_mode != LPM_FLASHED) {
+        p = ptr->parent;
+        i = ptr->from;
+        j = ptr->to;
+        volts = gsl_vector_get (p->voltage, i) - gsl_vector_get (p->voltage, j);
+        if (next_lpm_sample (ptr, volts) >= 0) {
+            ptr->pts[ptr->npts++] = (float) volts;
+        }
+        if (volts > 0.0) {
+            sign = 1;
+            x = ptr->xpos;
+        } else if (volts < 0.0) {
+            sign = -1;
+            x = ptr->xneg;
+        } else {  // no voltage means no leader propagation
+            return;
+        }
+        volts = fabs (volts);
+        ds = volts * ptr->k * dT;
+        ds2 = ds * volts / x;
+        ds *= ptr->e0;
+        dx = ds2 - ds;
+        if (sign > 0) {
+            if (dx > 0.0) {  // leader moves only when pushed the right direction
+                ptr->xpos -= dx;
+            }
+            if (volts > ptr->vpk_pos) {
+                ptr->vpk_pos = volts;
+            }
+        } else {
+            if (dx > 0.0) {
+                ptr->xneg -= dx;
+            }
+            if (volts > ptr->vpk_neg) {
+                ptr->vpk_neg = volts;
+            }
+        }
+        if (ptr->flash_mode == LPM_DISABLE_FLASH) { // need to keep waveshape, vpk_pos, and vpk_neg
+            return;
+        }
+        if ((ptr->xpos <= 0.0) ||
+            (ptr->xneg <= 0.0)) {
+            ptr->flash_mode = LPM_FLASHED;
+            if (flash_halt_enabled) {
+                flash_halt = TRUE;
+            }
+            ptr->t_flash = t;
+            if (substep_switching) {  /* when the leader bridged the gap */
+                ptr->t_flash = crossing_time (x, sign > 0 ? ptr->xpos : ptr->xneg, 0.0);
+                (void) switch_within_step (ptr->parent, ptr->t_flash);
+            }
+            add_y (p, i, j, Y_SHORT);
+            TriggerPlotCapture (ptr->t_flash);
+        }
+    }
+}
+
@@ -1,102 +1,122 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-#ifndef pole_included
-#define pole_included
-
-// extern char pair_token[];
-// extern char pole_token[];
-extern char pole_label_token[];
-extern char phase_label_token[];
-
-/* pole and node numbers for branch connections, used in parsing input */
-extern int assign_i;
-extern int assign_j;
-extern int assign_k;
-
-/* as used by LPDW, some of the poles have no insulators, arresters, grounds,
-or other compenents.  In that case, we don't need to solve for phase voltages
-at each time step, and the traveling waves in modal coordinates simply pass
-through */
-
-struct pole {
-	int location; /* pole number, 1 to number_of_poles */
-	int dirty; /* TRUE if the Ybus matrix has been modified - retriangulate */
-	int solve; /* TRUE if we need to solve for phase voltages at this pole */
-	int num_nonlinear;
-	struct arrbez **backptr;
-	gsl_vector *voltage; /* node voltages - dimensioned n+1 so voltage[0] is ground */
-	gsl_vector *injection; /* vector of parallel current injections - also dimensiond n+1 */
-	/* vmode and imode dimensioned number_of_nodes, don't know #conductors when allocated */
-	gsl_vector *vmode; /* node voltages in modal coordinates */
-	gsl_vector *imode; /* current injections in modal coordinates */
-	gsl_permutation *perm; /* stores row operations for triangularizing Ybus */
-	gsl_matrix *Ybus; /* nodal admittance matrix */
-	gsl_matrix *y; /* triangularized Ybus */
-	gsl_matrix *rcols;
-	gsl_matrix *Rthev;
-	gsl_permutation *jperm;
-	gsl_vector *vnew;
-	gsl_vector *inew;
-	gsl_vector *f;
-	gsl_matrix *jacobian;
-	struct pole *next;
-};
-
-/* These matrices are all dimensioned number_of_conductors x number_of_conductors. */
-struct span {
-	gsl_matrix *Zm; /* modal surge impedances */
-	gsl_matrix *Ym; /* inverse of Zm */
-	gsl_matrix *Zp; /* phase surge impedances */
-	gsl_matrix *Yp; /* inverse of Zp */
-	gsl_matrix *Ti; /* modal transformation matrices */
-	gsl_matrix *Tit;
-	gsl_matrix *Tv;
-	gsl_matrix *Tvt;
-	gsl_vector *vm; /* vector of offset voltages at a pole, modal coordinates */
-	gsl_vector *vp_offset; /* vector of offset voltages at a pole, phase coordinates */
-	double wave_velocity;
-	int span_id;
-	struct span *next;
-};
-
-extern struct pole *pole_head, *pole_ptr;
-
-int init_pole_list (void);
-int reset_assignments (void);
-int update_assignments (int i, int j, int k);
-int next_assignment (int *i, int *j, int *k);
-struct pole *new_pole (int location);
-void terminate_pole (struct pole *ptr, struct span *defn);
-
-void do_all_poles (void (*verb) (struct pole *));
-
-struct pole *find_pole (int location);
-struct span *find_pole_defn (struct pole *ptr);
-void triang_pole (struct pole *ptr);
-void solve_pole (struct pole *ptr);
-void build_rthev (struct pole *ptr);
-void zero_pole_injection (struct pole *ptr);
-void calc_pole_vmode (struct pole *ptr); /* only for non-network systems */
-void inject_pole_imode (struct pole *ptr); /* only for non-network systems */
-void add_y (struct pole *ptr, int j, int k, double y);
-void print_pole_data (struct pole *ptr);
-
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef pole_included
+#define pole_included
+
+// extern char pair_token[];
+// extern char pole_token[];
+extern char pole_label_token[];
+extern char phase_label_token[];
+
+/* pole and node numbers for branch connections, used in parsing input */
+extern int assign_i;
+extern int assign_j;
+extern int assign_k;
+
+/* as used by LPDW, some of the poles have no insulators, arresters, grounds,
+or other compenents.  In that case, we don't need to solve for phase voltages
+at each time step, and the traveling waves in modal coordinates simply pass
+through */
+
+struct pole {
+	int location; /* pole number, 1 to number_of_poles */
+	int dirty; /* TRUE if the Ybus matrix has been modified - retriangulate */
+	int solve; /* TRUE if we need to solve for phase voltages at this pole */
+	int resync; /* TRUE if substep_switching solves this pole again from a crossing, */
+	double t_resync; /* the earliest one within the step */
+	int num_nonlinear;
+	int num_grounds; /* implicit grounds, solved with the arrbez */
+	int num_ports; /* num_nonlinear + num_grounds, once triang_pole has set up the ports */
+	struct arrbez **backptr;
+	struct ground **ground_ports;
+	gsl_vector *voltage; /* node voltages - dimensioned n+1 so voltage[0] is ground */
+	gsl_vector *injection; /* vector of parallel current injections - also dimensiond n+1 */
+	/* vmode and imode dimensioned number_of_nodes, don't know #conductors when allocated */
+	gsl_vector *vmode; /* node voltages in modal coordinates */
+	gsl_vector *imode; /* current injections in modal coordinates */
+	gsl_permutation *perm; /* stores row operations for triangularizing Ybus */
+	gsl_matrix *Ybus; /* nodal admittance matrix */
+	gsl_matrix *y; /* triangularized Ybus */
+	gsl_matrix *rcols;
+	gsl_matrix *Rthev;
+	gsl_permutation *jperm;
+	gsl_vector *vnew;
+	gsl_vector *inew;
+	gsl_vector *f;
+	gsl_matrix *jacobian;
+	double *bezval; /* Newton workspace, num_ports each: port currents, */
+	double *bezd1;  /* their slopes, the open-circuit voltages, */
+	double *voc;
+	double *jd1;    /* the slopes that the factored jacobian was built with, */
+	double *vport;  /* and the implicit ground voltages with their slopes */
+	double *dvport;
+	int jfactored;  /* TRUE if jacobian still holds usable LU factors for chord steps */
+	long nr_iter;   /* Newton iterations at this pole */
+	int nr_max;
+	gsl_vector *dvoltage; /* tangents of voltage, injection, vmode and imode */
+	gsl_vector *dinjection; /* with respect to the stroke peak current, */
+	gsl_vector *dvmode;   /* allocated only when sensitivity is wanted */
+	gsl_vector *dimode;
+	struct pole *next;
+};
+
+/* These matrices are all dimensioned number_of_conductors x number_of_conductors. */
+struct span {
+	gsl_matrix *Zm; /* modal surge impedances */
+	gsl_matrix *Ym; /* inverse of Zm */
+	gsl_matrix *Zp; /* phase surge impedances */
+	gsl_matrix *Yp; /* inverse of Zp */
+	gsl_matrix *Ti; /* modal transformation matrices */
+	gsl_matrix *Tit;
+	gsl_matrix *Tv;
+	gsl_matrix *Tvt;
+	gsl_vector *vm; /* vector of offset voltages at a pole, modal coordinates */
+	gsl_vector *vp_offset; /* vector of offset voltages at a pole, phase coordinates */
+	double wave_velocity;
+	int span_id;
+	struct span *next;
+};
+
+extern struct pole *pole_head, *pole_ptr;
+
+int init_pole_list (void);
+int reset_assignments (void);
+int update_assignments (int i, int j, int k);
+int next_assignment (int *i, int *j, int *k);
+struct pole *new_pole (int location);
+void terminate_pole (struct pole *ptr, struct span *defn);
+
+void do_all_poles (void (*verb) (struct pole *));
+
+struct pole *find_pole (int location);
+void free_pole_index (void);
+struct span *find_pole_defn (struct pole *ptr);
+void triang_pole (struct pole *ptr);
+void solve_pole (struct pole *ptr);
+void build_rthev (struct pole *ptr);
+void reset_pole (struct pole *ptr);
+void zero_pole_injection (struct pole *ptr);
+void calc_pole_vmode (struct pole *ptr); /* only for non-network systems */
+void inject_pole_imode (struct pole *ptr); /* only for non-network systems */
+void add_y (struct pole *ptr, int j, int k, double y);
+void print_pole_data (struct pole *ptr);
+
 #endif
\ No newline at end of file
@@ -1,139 +1,187 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-/* This module contains the time-step loop and supporting functions for
-LPDW's transient simulation engine, based on H. W. Dommel's IEEE papers.
-Called from the driver and xfmr modules. */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include <time.h>
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_matrix.h>
-#include <gsl/gsl_blas.h>
-#include <gsl/gsl_linalg.h>
-
-#include "../OETypes.h"
-#include "../Parser.h"
-#include "../ReadUtils.h"
-#include "Pole.h"
-#include "Surge.h"
-
-char surge_token[] = "surge";
-
-struct surge *surge_head, *surge_ptr;
-
-/* calculate surge current value, and inject it at the pole */
-
-void inject_surge (struct surge *ptr)
-{
-	double cosarg, x, i;
-
-	x = t - ptr->tstart; /* shift time for surge starting time */
-	if (x > 0.0) {
-		if (x > ptr->tailadvance) { /* on the tail, use exponential */
-			x -= ptr->tailadvance;
-			i = ptr->peak * exp (-x / ptr->tau);
-		} else { /* on the front, use 1 - cosine */
-			cosarg = x * ptr->cfront;
-			i = ptr->peak * 0.5 * (1.0 - cos (cosarg));
-		}
-		*gsl_vector_ptr (ptr->parent->injection, ptr->from) += i;
-		*gsl_vector_ptr (ptr->parent->injection, ptr->to) -= i;
-	}
-}
-
-int init_surge_list (void)
-{
-	if (((surge_head = (struct surge *) malloc (sizeof *surge_head)) != NULL)) {
-		surge_head->next = NULL;
-		surge_ptr = surge_head;
-		return (0);
-	}
-	if (logfp) fprintf( logfp, "can't initialize surge list\n");
-	oe_exit (ERR_MALLOC);
-	return (1);
-}
-
-void do_all_surges (void (*verb) (struct surge *))
-{
-	surge_ptr = surge_head;
-	while ((surge_ptr = surge_ptr->next) != NULL) {
-		verb (surge_ptr);
-	}
-}
-
-/* read a current surge from the file or buffer, and set up the surge struct */
-
-int read_surge (void)
-{
-	int i, j, k;
-	double fpeak, ftf, ftt, ftstart;
-	struct surge *ptr;
-	
-	(void) next_double (&fpeak);
-	(void) next_double (&ftf);
-	(void) next_double (&ftt);
-	(void) next_double (&ftstart);
-	(void) read_pairs ();
-	(void) read_poles ();
-	(void) reset_assignments ();
-	while (!next_assignment (&i, &j, &k)) {
-		if (((ptr = (struct surge *) malloc (sizeof *ptr)) != NULL)) {
-			move_surge (ptr, i, j, k, fpeak, ftf, ftt, ftstart);
-			ptr->next = NULL;
-			surge_ptr->next = ptr;
-			surge_ptr = ptr;
-		} else {
-			if (logfp) fprintf( logfp, "can't allocate new surge\n");
-			oe_exit (ERR_MALLOC);
-		}
-	}
-	return (0);
-}
-
-/* adjust the surge parameters and location, can be called many times
-during flashover critical current iterations */
-
-void move_surge (struct surge *ptr, int i, int j, int k, double fpeak,
-	double ftf, double ftt, double ftstart)
-{
-	double fcfront, fctail, ftailadvance, ftau;
-
-/* set struct parameters to input parameters */
-	fcfront = TWOPI / (CFKONST * ftf);
-	fctail = TWOPI / (CTKONST * ftt);
-	ftailadvance = 0.5 * CFKONST * ftf;
-	ftau = ETKONST * (ftt - ftailadvance);
-	ptr->front = ftf;
-	ptr->tail = ftt;
-	ptr->cfront = fcfront;
-	ptr->ctail = fctail;
-	ptr->tailadvance = ftailadvance;
-	ptr->tstart = ftstart;
-	ptr->tau = ftau;
-	ptr->peak = fpeak;
-	ptr->parent = find_pole (i);
-	if (!ptr->parent) oe_exit (ERR_BAD_POLE);
-	ptr->parent->solve = TRUE;
-	ptr->from = j;
-	ptr->to = k;
-}
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This module contains the time-step loop and supporting functions for
+LPDW's transient simulation engine, based on H. W. Dommel's IEEE papers.
+Called from the driver and xfmr modules. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+
+#include "../OETypes.h"
+#include "../Parser.h"
+#include "../ReadUtils.h"
+#include "Pole.h"
+#include "Surge.h"
+
+char surge_token[] = "surge";
+char surgewave_token[] = "surgewave";
+
+struct surge *surge_head, *surge_ptr;
+
+/* the surge shape at x seconds after it starts, per unit of the peak */
+
+static double surge_shape (void *data, double x)
+{
+	struct surge *ptr = (struct surge *) data;
+
+	if (ptr->record) {
+		return wave_record_value (ptr->record, x);
+	}
+	if (x > ptr->tailadvance) { /* on the tail, use exponential */
+		return exp (-(x - ptr->tailadvance) / ptr->tau);
+	}
+	return 0.5 * (1.0 - cos (x * ptr->cfront)); /* on the front, use 1 - cosine */
+}
+
+double surge_unit (struct surge *ptr)
+{
+	return wave_table_value (&ptr->wave, t - ptr->tstart, surge_shape, ptr);
+}
+
+/* calculate surge current value, and inject it at the pole */
+
+void inject_surge (struct surge *ptr)
+{
+	double i;
+
+	i = ptr->peak * surge_unit (ptr);
+	if (t > ptr->tstart) {
+		*gsl_vector_ptr (ptr->parent->injection, ptr->from) += i;
+		*gsl_vector_ptr (ptr->parent->injection, ptr->to) -= i;
+	}
+}
+
+int init_surge_list (void)
+{
+	if (((surge_head = (struct surge *) malloc (sizeof *surge_head)) != NULL)) {
+		surge_head->next = NULL;
+		surge_head->record = NULL;
+		init_wave_table (&surge_head->wave);
+		surge_ptr = surge_head;
+		return (0);
+	}
+	if (logfp) fprintf( logfp, "can't initialize surge list\n");
+	oe_exit (ERR_MALLOC);
+	return (1);
+}
+
+void do_all_surges (void (*verb) (struct surge *))
+{
+	surge_ptr = surge_head;
+	while ((surge_ptr = surge_ptr->next) != NULL) {
+		verb (surge_ptr);
+	}
+}
+
+/* read a current surge from the file or buffer, and set up the surge struct.
+A surgewave has a measured shape in place of the front and tail times. */
+
+static int read_surge_shape (int measured)
+{
+	int i, j, k;
+	double fpeak, ftf, ftt, ftstart;
+	struct surge *ptr;
+	struct wave_record *record;
+	
+	(void) next_double (&fpeak);
+	ftf = ftt = 0.0;
+	if (!measured) {
+		(void) next_double (&ftf);
+		(void) next_double (&ftt);
+	}
+	(void) next_double (&ftstart);
+	record = measured ? read_wave_record () : NULL;
+	(void) read_pairs ();
+	(void) read_poles ();
+	(void) reset_assignments ();
+	while (!next_assignment (&i, &j, &k)) {
+		if (((ptr = (struct surge *) malloc (sizeof *ptr)) != NULL)) {
+			ptr->record = record ? copy_wave_record (record) : NULL;
+			init_wave_table (&ptr->wave);
+			ptr->front = ptr->tail = ptr->tstart = 0.0;
+			move_surge (ptr, i, j, k, fpeak, ftf, ftt, ftstart);
+			ptr->next = NULL;
+			surge_ptr->next = ptr;
+			surge_ptr = ptr;
+		} else {
+			if (logfp) fprintf( logfp, "can't allocate new surge\n");
+			oe_exit (ERR_MALLOC);
+		}
+	}
+	free_wave_record (record);
+	return (0);
+}
+
+int read_surge (void)
+{
+	return read_surge_shape (FALSE);
+}
+
+int read_surgewave (void)
+{
+	return read_surge_shape (TRUE);
+}
+
+void free_surge (struct surge *ptr)
+{
+	free_wave_record (ptr->record);
+	free_wave_table (&ptr->wave);
+	free (ptr);
+}
+
+/* adjust the surge parameters and location, can be called many times
+during flashover critical current iterations.  A surgewave keeps its
+measured shape, so ftf and ftt only matter without a record; -fronts
+and Monte Carlo front sampling then change only the peak current. */
+
+void move_surge (struct surge *ptr, int i, int j, int k, double fpeak,
+	double ftf, double ftt, double ftstart)
+{
+	double fcfront, fctail, ftailadvance, ftau;
+
+/* set struct parameters to input parameters */
+	fcfront = TWOPI / (CFKONST * ftf);
+	fctail = TWOPI / (CTKONST * ftt);
+	ftailadvance = 0.5 * CFKONST * ftf;
+	ftau = ETKONST * (ftt - ftailadvance);
+	if (ftstart != ptr->tstart || (!ptr->record && (ftf != ptr->front || ftt != ptr->tail))) {
+		expire_wave_table (&ptr->wave);
+	}
+	ptr->front = ftf;
+	ptr->tail = ftt;
+	ptr->cfront = fcfront;
+	ptr->ctail = fctail;
+	ptr->tailadvance = ftailadvance;
+	ptr->tstart = ftstart;
+	ptr->tau = ftau;
+	ptr->peak = fpeak;
+	ptr->parent = find_pole (i);
+	if (!ptr->parent) oe_exit (ERR_BAD_POLE);
+	ptr->parent->solve = TRUE;
+	ptr->from = j;
+	ptr->to = k;
+}
@@ -0,0 +1,192 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* This module keeps the stroke current shapes on the time-step grid, for
+the surge and steepfront components.  Both time loops start from t = 0 and
+accumulate t += dT, so a sample taken at step k in one run is the same
+number that run would compute at step k of any later run, until dT or
+the shape parameters change.  After the second time step is switched in,
+the steps no longer fall on the grid and the shape is evaluated directly.
+
+Measured waveforms are read as time and current points, scaled to unit
+peak, and interpolated linearly.  The last value holds past the end. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../OETypes.h"
+#include "../Parser.h"
+#include "../ChangeTimeStep.h"
+#include "WaveTable.h"
+
+void init_wave_table (struct wave_table *w)
+{
+	w->dT = 0.0;
+	w->n = 0;
+	w->size = 0;
+	w->y = NULL;
+}
+
+void expire_wave_table (struct wave_table *w)
+{
+	w->dT = 0.0;
+	w->n = 0;
+}
+
+/* shape at x seconds after the stroke starts, for the current step */
+
+double wave_table_value (struct wave_table *w, double x, wave_shape shape, void *data)
+{
+	double val;
+	int size;
+
+	if (dT_switched || substep_resync) {  /* off the step grid */
+		return (x > 0.0) ? shape (data, x) : 0.0;
+	}
+	if (w->dT != dT) {
+		size = (int) (Tmax / dT) + 2;
+		if (size > w->size) {
+			free (w->y);
+			if ((w->y = (double *) malloc (size * sizeof (double))) == NULL) {
+				if (logfp) fprintf (logfp, "can't allocate stroke waveform table\n");
+				oe_exit (ERR_MALLOC);
+			}
+			w->size = size;
+		}
+		w->dT = dT;
+		w->n = 0;
+	}
+	if (step < w->n) {
+		return w->y[step];
+	}
+	val = (x > 0.0) ? shape (data, x) : 0.0;
+	if (step == w->n && step < w->size) {
+		w->y[w->n++] = val;
+	}
+	return val;
+}
+
+void free_wave_table (struct wave_table *w)
+{
+	free (w->y);
+	init_wave_table (w);
+}
+
+/* the count and points may continue onto following lines */
+
+static char *next_wave_token (void)
+{
+	char *p;
+
+	if ((p = next_token ()) == NULL && (p = first_token ()) == NULL) {
+		if (logfp) fprintf (logfp, "missing stroke waveform points\n");
+		oe_exit (ERR_OUT_OF_RANGE);
+	}
+	return p;
+}
+
+static struct wave_record *allocate_wave_record (int npts)
+{
+	struct wave_record *r;
+
+	if ((r = (struct wave_record *) malloc (sizeof *r)) != NULL) {
+		r->npts = npts;
+		r->t = (double *) malloc (npts * sizeof (double));
+		r->y = (double *) malloc (npts * sizeof (double));
+		if (r->t && r->y) return r;
+	}
+	if (logfp) fprintf (logfp, "can't allocate stroke waveform\n");
+	oe_exit (ERR_MALLOC);
+	return NULL;
+}
+
+/* read npts, then npts pairs of time and current */
+
+struct wave_record *read_wave_record (void)
+{
+	struct wave_record *r;
+	double big;
+	int i, npts;
+
+	npts = atoi (next_wave_token ());
+	if (npts < 2) {
+		if (logfp) fprintf (logfp, "stroke waveform needs at least 2 points, not %d\n", npts);
+		oe_exit (ERR_OUT_OF_RANGE);
+	}
+	r = allocate_wave_record (npts);
+	big = 0.0;
+	for (i = 0; i < npts; i++) {
+		r->t[i] = atof (next_wave_token ());
+		r->y[i] = atof (next_wave_token ());
+		if (i > 0 && r->t[i] <= r->t[i-1]) {
+			if (logfp) fprintf (logfp, "stroke waveform times must increase, point %d\n", i + 1);
+			oe_exit (ERR_OUT_OF_RANGE);
+		}
+		if (fabs (r->y[i]) > big) big = fabs (r->y[i]);
+	}
+	if (big <= 0.0) {
+		if (logfp) fprintf (logfp, "stroke waveform is all zero\n");
+		oe_exit (ERR_OUT_OF_RANGE);
+	}
+	for (i = 0; i < npts; i++) {
+		r->y[i] /= big;
+	}
+	return r;
+}
+
+struct wave_record *copy_wave_record (struct wave_record *r)
+{
+	struct wave_record *c;
+	int i;
+
+	c = allocate_wave_record (r->npts);
+	for (i = 0; i < r->npts; i++) {
+		c->t[i] = r->t[i];
+		c->y[i] = r->y[i];
+	}
+	return c;
+}
+
+double wave_record_value (void *data, double x)
+{
+	struct wave_record *r = (struct wave_record *) data;
+	int lo, hi, mid;
+
+	if (x <= r->t[0]) return 0.0;
+	hi = r->npts - 1;
+	if (x >= r->t[hi]) return r->y[hi];
+	lo = 0;
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (r->t[mid] <= x) lo = mid; else hi = mid;
+	}
+	return r->y[lo] + (r->y[hi] - r->y[lo]) * (x - r->t[lo]) / (r->t[hi] - r->t[lo]);
+}
+
+void free_wave_record (struct wave_record *r)
+{
+	if (r) {
+		free (r->t);
+		free (r->y);
+		free (r);
+	}
+}
@@ -0,0 +1,55 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef wavetable_included
+#define wavetable_included
+
+/* The stroke currents are sampled on the time-step grid at unit peak, and
+scaled by the peak current when injected.  Each sample is kept the first
+time its step is reached, so the shape is evaluated once per table rather
+than once per step of every run. */
+
+typedef double (*wave_shape) (void *data, double x);  /* unit shape at x > 0 after the start */
+
+struct wave_table {
+	double dT;  /* time step of the samples, 0 for none */
+	int n;  /* y[k] holds the shape at step k, for k < n */
+	int size;
+	double *y;
+};
+
+struct wave_record { /* measured stroke current, straight lines between points */
+	int npts;
+	double *t;  /* seconds after the start, increasing */
+	double *y;  /* per unit of the largest magnitude */
+};
+
+void init_wave_table (struct wave_table *w);
+void expire_wave_table (struct wave_table *w);  /* after the shape parameters change */
+double wave_table_value (struct wave_table *w, double x, wave_shape shape, void *data);
+void free_wave_table (struct wave_table *w);
+
+struct wave_record *read_wave_record (void);
+struct wave_record *copy_wave_record (struct wave_record *r);
+double wave_record_value (void *data, double x);  /* a wave_shape for the record */
+void free_wave_record (struct wave_record *r);
+
+#endif
@@ -0,0 +1,1204 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This file contains functions to simulate several stroke currents in
+lockstep, for the critical current iterations.  The cases share the
+topology and all of the linear components, so each pole matrix is factored
+once.  The injections, voltages and history terms of the cases are stored
+side by side, one lane per case, and each pass through a component updates
+every lane.
+
+Arresters and pipegaps switch at different times in different lanes, so
+they are left out of the pole factors.  In each lane, the conducting ones
+are compensated into the solution with the Thevenin resistances seen from
+the switched branches, much as solve_pole does for arrbez:
+  (1 / y + Rthev) i = v_open
+  v = v_open - Z i
+where the columns of Z are Ybus^-1 times each branch incidence vector.
+A lane stops when one of its insulators or LPMs flashes over, since the
+answer for that lane is then known. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_linalg.h>
+
+#include "OETypes.h"
+#include "OERead.h"
+#include "ChangeTimeStep.h"
+#include "Lockstep.h"
+#include "AllComponents.h"
+
+#define LANE(row) ((row) * MAX_LANES)  /* offset of a node or mode in a lane block */
+
+struct pole_lanes {
+	struct pole *pole;
+	double *voltage;    /* (number_of_nodes + 1) x MAX_LANES, node 0 is ground */
+	double *injection;
+	double *vmode;      /* number_of_nodes x MAX_LANES */
+	double *imode;
+	int num_switched;
+	int *switched;      /* indices into the switch table */
+	double *zcols;      /* num_switched x number_of_nodes */
+	double *rthev;      /* num_switched x num_switched */
+	int *on;            /* workspace for the conducting branches of one lane */
+	double *work;
+	double *w;
+};
+
+struct switch_lanes {  /* an arrester or a pipegap */
+	struct arrester *arrester;
+	struct pipegap *pipegap;
+	int pole;
+	int from;
+	int to;
+	double y;
+	int conducting [MAX_LANES];
+	double i_past [MAX_LANES];
+	double i [MAX_LANES];
+	double h [MAX_LANES];
+	double i_bias [MAX_LANES];
+	double i_peak [MAX_LANES];
+	double energy [MAX_LANES];
+	double charge [MAX_LANES];
+};
+
+struct ground_lanes {
+	struct ground *ground;
+	int pole;
+	double h [MAX_LANES];
+	double i [MAX_LANES];
+};
+
+struct history_lanes {  /* an inductor or capacitor, with h = a * h + b * v */
+	int pole;
+	int from;
+	int to;
+	double a;
+	double b;
+	double h [MAX_LANES];
+};
+
+struct insulator_lanes {
+	struct insulator *insulator;
+	int pole;
+	double de_pos [MAX_LANES];
+	double de_neg [MAX_LANES];
+};
+
+struct lpm_lanes {
+	struct lpm *lpm;
+	int pole;
+	double xpos [MAX_LANES];
+	double xneg [MAX_LANES];
+	double vpk_pos [MAX_LANES];
+	double vpk_neg [MAX_LANES];
+	float *pts;  /* MAX_LANES x nsteps, so each lane's waveform is contiguous */
+	int npts [MAX_LANES];  /* samples kept, as in next_lpm_sample */
+};
+
+struct line_lanes {
+	struct line *line;
+	int left;
+	int right;
+	double *hist_left;  /* number_of_conductors x alloc_steps x MAX_LANES */
+	double *hist_right;
+};
+
+static struct pole_lanes *poles = NULL;
+static struct switch_lanes *switches = NULL;
+static struct ground_lanes *grounds = NULL;
+static struct history_lanes *histories = NULL;
+static struct insulator_lanes *insulators = NULL;
+static struct lpm_lanes *lpms = NULL;
+static struct line_lanes *lines = NULL;
+static int num_poles, num_switches, num_grounds, num_histories;
+static int num_insulators, num_lpms, num_lines;
+static int *pole_index = NULL;  /* by pole location, -1 if parked */
+static int lpm_steps;
+
+static int width;  /* lanes still processed; the highest ones that stopped are dropped */
+static int live [MAX_LANES];
+static int checking [MAX_LANES];  /* lanes whose switch states are being checked */
+static double peak [MAX_LANES];
+static int flashed [MAX_LANES];  /* TRUE if the lane stopped on a flashover */
+
+static struct surge *stroke_surge;
+static struct steepfront *stroke_steepfront;
+static int stroke_pole;
+
+static void *lane_alloc (size_t count, size_t size)
+{
+	void *p;
+
+	if (!(p = calloc (count > 0 ? count : 1, size))) {
+		if (logfp) fprintf (logfp, "can't allocate lockstep lanes\n");
+		oe_exit (ERR_MALLOC);
+	}
+	return p;
+}
+
+/* The compensation needs a real admittance at both ends of each switched
+branch, not the Y_OPEN that triang_pole puts on an empty diagonal. */
+
+int lockstep_supported (void)
+{
+	struct pole *p;
+
+	if (arrbez_head->next || using_second_dT || implicit_grounds || substep_switching) {
+		return FALSE;
+	}
+	if (!surge_head->next && !steepfront_head->next) {
+		return FALSE;
+	}
+	arrester_ptr = arrester_head;
+	while ((arrester_ptr = arrester_ptr->next) != NULL) {
+		p = arrester_ptr->parent;
+		if (arrester_ptr->from > 0 && gsl_matrix_get (p->Ybus, arrester_ptr->from - 1, arrester_ptr->from - 1) <= 0.0) return FALSE;
+		if (arrester_ptr->to > 0 && gsl_matrix_get (p->Ybus, arrester_ptr->to - 1, arrester_ptr->to - 1) <= 0.0) return FALSE;
+	}
+	pipegap_ptr = pipegap_head;
+	while ((pipegap_ptr = pipegap_ptr->next) != NULL) {
+		p = pipegap_ptr->parent;
+		if (pipegap_ptr->from > 0 && gsl_matrix_get (p->Ybus, pipegap_ptr->from - 1, pipegap_ptr->from - 1) <= 0.0) return FALSE;
+		if (pipegap_ptr->to > 0 && gsl_matrix_get (p->Ybus, pipegap_ptr->to - 1, pipegap_ptr->to - 1) <= 0.0) return FALSE;
+	}
+	return TRUE;
+}
+
+/* &&&&  setting up the lanes from the component lists */
+
+static int find_lane_pole (struct pole *ptr)
+{
+	int i = pole_index [ptr->location];
+
+	if (i < 0) {
+		if (logfp) fprintf (logfp, "lockstep lanes can't find pole %d\n", ptr->location);
+		oe_exit (ERR_BAD_POLE);
+	}
+	return i;
+}
+
+static void build_poles (void)
+{
+	struct pole_lanes *pl;
+	int i, n = number_of_nodes;
+
+	pole_index = (int *) lane_alloc (number_of_poles + 1, sizeof (int));
+	for (i = 0; i <= number_of_poles; i++) {
+		pole_index [i] = -1;
+	}
+	num_poles = 0;
+	pole_ptr = pole_head;
+	while ((pole_ptr = pole_ptr->next) != NULL) {
+		++num_poles;
+	}
+	poles = (struct pole_lanes *) lane_alloc (num_poles, sizeof *poles);
+	i = 0;
+	pole_ptr = pole_head;
+	while ((pole_ptr = pole_ptr->next) != NULL) {
+		pl = &poles [i];
+		pl->pole = pole_ptr;
+		pl->voltage = (double *) lane_alloc ((n + 1) * MAX_LANES, sizeof (double));
+		pl->injection = (double *) lane_alloc ((n + 1) * MAX_LANES, sizeof (double));
+		pl->vmode = (double *) lane_alloc (n * MAX_LANES, sizeof (double));
+		pl->imode = (double *) lane_alloc (n * MAX_LANES, sizeof (double));
+		pole_index [pole_ptr->location] = i++;
+	}
+}
+
+static void add_switch (struct switch_lanes *sw, struct pole *parent, int from, int to, double y)
+{
+	sw->pole = find_lane_pole (parent);
+	sw->from = from;
+	sw->to = to;
+	sw->y = y;
+	++poles [sw->pole].num_switched;
+}
+
+static void build_switches (void)
+{
+	struct switch_lanes *sw;
+	int i, l;
+
+	num_switches = 0;
+	arrester_ptr = arrester_head;
+	while ((arrester_ptr = arrester_ptr->next) != NULL) {
+		++num_switches;
+	}
+	pipegap_ptr = pipegap_head;
+	while ((pipegap_ptr = pipegap_ptr->next) != NULL) {
+		++num_switches;
+	}
+	switches = (struct switch_lanes *) lane_alloc (num_switches, sizeof *switches);
+	sw = switches;
+	arrester_ptr = arrester_head;
+	while ((arrester_ptr = arrester_ptr->next) != NULL) {
+		sw->arrester = arrester_ptr;
+		add_switch (sw, arrester_ptr->parent, arrester_ptr->from, arrester_ptr->to, arrester_ptr->y);
+		for (l = 0; l < MAX_LANES; l++) {
+			sw->conducting [l] = arrester_ptr->conducting;
+			sw->i_past [l] = arrester_ptr->i_past;
+			sw->i [l] = arrester_ptr->i;
+			sw->h [l] = arrester_ptr->h;
+			sw->i_bias [l] = arrester_ptr->i_bias;
+			sw->i_peak [l] = arrester_ptr->i_peak;
+			sw->energy [l] = arrester_ptr->energy;
+			sw->charge [l] = arrester_ptr->charge;
+		}
+		++sw;
+	}
+	pipegap_ptr = pipegap_head;
+	while ((pipegap_ptr = pipegap_ptr->next) != NULL) {
+		sw->pipegap = pipegap_ptr;
+		add_switch (sw, pipegap_ptr->parent, pipegap_ptr->from, pipegap_ptr->to, pipegap_ptr->y);
+		for (l = 0; l < MAX_LANES; l++) {
+			sw->conducting [l] = pipegap_ptr->conducting;
+			sw->i_past [l] = pipegap_ptr->i_past;
+			sw->i_peak [l] = pipegap_ptr->i_peak;
+		}
+		++sw;
+	}
+	for (i = 0; i < num_poles; i++) {
+		poles [i].switched = (int *) lane_alloc (poles [i].num_switched, sizeof (int));
+		poles [i].num_switched = 0;
+	}
+	for (i = 0; i < num_switches; i++) {
+		sw = &switches [i];
+		poles [sw->pole].switched [poles [sw->pole].num_switched++] = i;
+	}
+}
+
+/* solve Ybus z = a for each switched branch, with the pole's base factors */
+
+static void build_compensation (struct pole_lanes *pl)
+{
+	struct switch_lanes *sa;
+	gsl_vector *z;
+	int a, b, n = number_of_nodes, ns = pl->num_switched;
+	double r;
+
+	if (ns < 1) {
+		return;
+	}
+	pl->zcols = (double *) lane_alloc (ns * n, sizeof (double));
+	pl->rthev = (double *) lane_alloc (ns * ns, sizeof (double));
+	pl->on = (int *) lane_alloc (ns, sizeof (int));
+	pl->work = (double *) lane_alloc (ns * ns, sizeof (double));
+	pl->w = (double *) lane_alloc (ns, sizeof (double));
+	if (!(z = gsl_vector_alloc (n))) {
+		if (logfp) fprintf (logfp, "can't allocate lockstep lanes\n");
+		oe_exit (ERR_MALLOC);
+	}
+	for (a = 0; a < ns; a++) {
+		sa = &switches [pl->switched [a]];
+		gsl_vector_set_zero (z);
+		if (sa->from > 0) gsl_vector_set (z, sa->from - 1, 1.0);
+		if (sa->to > 0) gsl_vector_set (z, sa->to - 1, -1.0);
+		gsl_linalg_LU_svx (pl->pole->y, pl->pole->perm, z);
+		for (b = 0; b < n; b++) {
+			pl->zcols [a * n + b] = gsl_vector_get (z, b);
+		}
+	}
+	gsl_vector_free (z);
+	for (a = 0; a < ns; a++) {
+		sa = &switches [pl->switched [a]];
+		for (b = 0; b < ns; b++) {
+			r = 0.0;
+			if (sa->from > 0) r += pl->zcols [b * n + sa->from - 1];
+			if (sa->to > 0) r -= pl->zcols [b * n + sa->to - 1];
+			pl->rthev [a * ns + b] = r;
+		}
+	}
+}
+
+static void build_components (void)
+{
+	struct history_lanes *hl;
+	int i, l;
+
+	num_grounds = 0;
+	ground_ptr = ground_head;
+	while ((ground_ptr = ground_ptr->next) != NULL) {
+		++num_grounds;
+	}
+	grounds = (struct ground_lanes *) lane_alloc (num_grounds, sizeof *grounds);
+	i = 0;
+	ground_ptr = ground_head;
+	while ((ground_ptr = ground_ptr->next) != NULL) {
+		grounds [i].ground = ground_ptr;
+		grounds [i].pole = find_lane_pole (ground_ptr->parent);
+		for (l = 0; l < MAX_LANES; l++) {
+			grounds [i].h [l] = ground_ptr->h;
+			grounds [i].i [l] = ground_ptr->i;
+		}
+		++i;
+	}
+
+	num_histories = 0;
+	inductor_ptr = inductor_head;
+	while ((inductor_ptr = inductor_ptr->next) != NULL) {
+		++num_histories;
+	}
+	capacitor_ptr = capacitor_head;
+	while ((capacitor_ptr = capacitor_ptr->next) != NULL) {
+		++num_histories;
+	}
+	histories = (struct history_lanes *) lane_alloc (num_histories, sizeof *histories);
+	hl = histories;
+	inductor_ptr = inductor_head;
+	while ((inductor_ptr = inductor_ptr->next) != NULL) {
+		hl->pole = find_lane_pole (inductor_ptr->parent);
+		hl->from = inductor_ptr->from;
+		hl->to = inductor_ptr->to;
+		hl->a = inductor_ptr->zi;
+		hl->b = inductor_ptr->yi;
+		for (l = 0; l < MAX_LANES; l++) {
+			hl->h [l] = inductor_ptr->h;
+		}
+		++hl;
+	}
+	capacitor_ptr = capacitor_head;
+	while ((capacitor_ptr = capacitor_ptr->next) != NULL) {
+		hl->pole = find_lane_pole (capacitor_ptr->parent);
+		hl->from = capacitor_ptr->from;
+		hl->to = capacitor_ptr->to;
+		hl->a = -1.0;
+		hl->b = -capacitor_ptr->yc;
+		for (l = 0; l < MAX_LANES; l++) {
+			hl->h [l] = capacitor_ptr->h;
+		}
+		++hl;
+	}
+
+	num_insulators = 0;
+	insulator_ptr = insulator_head;
+	while ((insulator_ptr = insulator_ptr->next) != NULL) {
+		++num_insulators;
+	}
+	insulators = (struct insulator_lanes *) lane_alloc (num_insulators, sizeof *insulators);
+	i = 0;
+	insulator_ptr = insulator_head;
+	while ((insulator_ptr = insulator_ptr->next) != NULL) {
+		insulators [i].insulator = insulator_ptr;
+		insulators [i].pole = find_lane_pole (insulator_ptr->parent);
+		for (l = 0; l < MAX_LANES; l++) {
+			insulators [i].de_pos [l] = insulator_ptr->de_pos;
+			insulators [i].de_neg [l] = insulator_ptr->de_neg;
+		}
+		++i;
+	}
+
+	num_lpms = 0;
+	lpm_ptr = lpm_head;
+	while ((lpm_ptr = lpm_ptr->next) != NULL) {
+		++num_lpms;
+	}
+	lpm_steps = (int) (Tmax / dT) + 2;  /* as in reset_lpm */
+	lpms = (struct lpm_lanes *) lane_alloc (num_lpms, sizeof *lpms);
+	i = 0;
+	lpm_ptr = lpm_head;
+	while ((lpm_ptr = lpm_ptr->next) != NULL) {
+		lpms [i].lpm = lpm_ptr;
+		lpms [i].pole = find_lane_pole (lpm_ptr->parent);
+		lpms [i].pts = (float *) lane_alloc (MAX_LANES * lpm_steps, sizeof (float));
+		for (l = 0; l < MAX_LANES; l++) {
+			lpms [i].xpos [l] = lpm_ptr->xpos;
+			lpms [i].xneg [l] = lpm_ptr->xneg;
+			lpms [i].vpk_pos [l] = lpm_ptr->vpk_pos;
+			lpms [i].vpk_neg [l] = lpm_ptr->vpk_neg;
+			lpms [i].npts [l] = 0;
+		}
+		++i;
+	}
+}
+
+static void build_lines (void)
+{
+	struct line_lanes *ll;
+	int i, k, l, m;
+
+	num_lines = 0;
+	line_ptr = line_head;
+	while ((line_ptr = line_ptr->next) != NULL) {
+		++num_lines;
+	}
+	lines = (struct line_lanes *) lane_alloc (num_lines, sizeof *lines);
+	ll = lines;
+	line_ptr = line_head;
+	while ((line_ptr = line_ptr->next) != NULL) {
+		ll->line = line_ptr;
+		ll->left = find_lane_pole (line_ptr->left);
+		ll->right = find_lane_pole (line_ptr->right);
+		m = number_of_conductors * line_ptr->alloc_steps;
+		ll->hist_left = (double *) lane_alloc (m * MAX_LANES, sizeof (double));
+		ll->hist_right = (double *) lane_alloc (m * MAX_LANES, sizeof (double));
+		for (i = 0; i < number_of_conductors; i++) {
+			for (k = 0; k < line_ptr->alloc_steps; k++) {
+				m = LANE (i * line_ptr->alloc_steps + k);
+				for (l = 0; l < MAX_LANES; l++) {
+					ll->hist_left [m + l] = gsl_matrix_get (line_ptr->hist_left, i, k);
+					ll->hist_right [m + l] = gsl_matrix_get (line_ptr->hist_right, i, k);
+				}
+			}
+		}
+		++ll;
+	}
+}
+
+static void free_lanes (void)
+{
+	int i;
+
+	for (i = 0; i < num_poles; i++) {
+		free (poles [i].voltage);
+		free (poles [i].injection);
+		free (poles [i].vmode);
+		free (poles [i].imode);
+		free (poles [i].switched);
+		free (poles [i].zcols);
+		free (poles [i].rthev);
+		free (poles [i].on);
+		free (poles [i].work);
+		free (poles [i].w);
+	}
+	for (i = 0; i < num_lpms; i++) {
+		free (lpms [i].pts);
+	}
+	for (i = 0; i < num_lines; i++) {
+		free (lines [i].hist_left);
+		free (lines [i].hist_right);
+	}
+	free (poles);
+	free (switches);
+	free (grounds);
+	free (histories);
+	free (insulators);
+	free (lpms);
+	free (lines);
+	free (pole_index);
+	poles = NULL;
+	switches = NULL;
+	grounds = NULL;
+	histories = NULL;
+	insulators = NULL;
+	lpms = NULL;
+	lines = NULL;
+	pole_index = NULL;
+}
+
+/* &&&&  injections, mirroring the inject_ functions of each component */
+
+static void add_lane_branch (struct pole_lanes *pl, int from, int to, const double *val, double sign)
+{
+	double *f = pl->injection + LANE (from);
+	double *g = pl->injection + LANE (to);
+	int l;
+
+	for (l = 0; l < width; l++) {
+		f [l] += sign * val [l];
+		g [l] -= sign * val [l];
+	}
+}
+
+/* sources and the other surges are the same in every lane, so the scalar
+functions inject them into the pole vectors first */
+
+static void inject_common (void)
+{
+	do_all_poles (zero_pole_injection);
+	surge_ptr = surge_head;
+	while ((surge_ptr = surge_ptr->next) != NULL) {
+		if (surge_ptr != stroke_surge) inject_surge (surge_ptr);
+	}
+	steepfront_ptr = steepfront_head;
+	while ((steepfront_ptr = steepfront_ptr->next) != NULL) {
+		if (steepfront_ptr != stroke_steepfront) inject_steepfront (steepfront_ptr);
+	}
+	do_all_sources (inject_source);
+}
+
+/* the stroke shapes scale with the peak current, as run_loop_case sets it */
+
+static void inject_stroke (void)
+{
+	double shape, amps [MAX_LANES];
+	int l, from, to;
+
+	if (stroke_surge) {
+		shape = surge_unit (stroke_surge);
+		if (t <= stroke_surge->tstart) return;
+		from = stroke_surge->from;
+		to = stroke_surge->to;
+	} else {
+		shape = steepfront_unit (stroke_steepfront);
+		if (t <= stroke_steepfront->tstart) return;
+		from = stroke_steepfront->from;
+		to = stroke_steepfront->to;
+	}
+	for (l = 0; l < width; l++) {
+		amps [l] = peak [l] * shape;
+	}
+	add_lane_branch (&poles [stroke_pole], from, to, amps, 1.0);
+}
+
+static void inject_line_lanes (struct line_lanes *ll)
+{
+	struct pole_lanes *pl;
+	double *h, *im;
+	int end, i, l, k;
+
+	k = step % ll->line->steps;
+	for (end = 0; end < 2; end++) {
+		pl = &poles [end ? ll->right : ll->left];
+		for (i = 0; i < number_of_conductors; i++) {
+			im = pl->imode + LANE (i);
+			h = (end ? ll->hist_right : ll->hist_left) + LANE (i * ll->line->alloc_steps + k);
+			for (l = 0; l < width; l++) {
+				im [l] -= h [l];
+			}
+		}
+	}
+}
+
+/* add T * imode to the lane injections, for the modal currents of one
+pole in non-network systems, or of one line end in network systems */
+
+static void inject_modes (struct pole_lanes *pl, gsl_matrix *T)
+{
+	const double *row;
+	double *inj, c;
+	int r, i, l;
+
+	for (r = 0; r < (int) T->size1; r++) {
+		inj = pl->injection + LANE (r + 1);
+		row = T->data + r * T->tda;
+		for (i = 0; i < (int) T->size2; i++) {
+			c = row [i];
+			for (l = 0; l < width; l++) {
+				inj [l] += c * pl->imode [LANE (i) + l];
+			}
+		}
+	}
+}
+
+static void inject_lanes (void)
+{
+	struct pole_lanes *pl;
+	struct switch_lanes *sw;
+	struct history_lanes *hl;
+	double val [MAX_LANES], c;
+	int i, j, l;
+
+	for (i = 0; i < num_poles; i++) {
+		pl = &poles [i];
+		for (j = 0; j <= number_of_nodes; j++) {
+			c = gsl_vector_get (pl->pole->injection, j);
+			for (l = 0; l < width; l++) {
+				pl->injection [LANE (j) + l] = c;
+			}
+		}
+		for (j = 0; j < LANE (number_of_nodes); j++) {
+			pl->imode [j] = 0.0;
+		}
+	}
+	inject_stroke ();
+	for (i = 0; i < num_grounds; i++) {
+		add_lane_branch (&poles [grounds [i].pole], grounds [i].ground->from, grounds [i].ground->to, grounds [i].i, -1.0);
+	}
+	if (using_multiple_span_defns) {
+		for (i = 0; i < num_lines; i++) {
+			for (j = 0; j < LANE (number_of_nodes); j++) {
+				poles [lines [i].left].imode [j] = poles [lines [i].right].imode [j] = 0.0;
+			}
+			inject_line_lanes (&lines [i]);
+			inject_modes (&poles [lines [i].left], lines [i].line->defn->Ti);
+			inject_modes (&poles [lines [i].right], lines [i].line->defn->Ti);
+		}
+	} else {
+		for (i = 0; i < num_lines; i++) {
+			inject_line_lanes (&lines [i]);
+		}
+		for (i = 0; i < num_poles; i++) {
+			if (poles [i].pole->solve) inject_modes (&poles [i], span_head->Ti);
+		}
+	}
+	for (i = 0; i < num_switches; i++) {
+		sw = &switches [i];
+		for (l = 0; l < width; l++) {
+			val [l] = sw->conducting [l] ? sw->i_past [l] : 0.0;
+		}
+		add_lane_branch (&poles [sw->pole], sw->from, sw->to, val, -1.0);
+	}
+	for (i = 0; i < num_histories; i++) {
+		hl = &histories [i];
+		add_lane_branch (&poles [hl->pole], hl->from, hl->to, hl->h, -1.0);
+	}
+}
+
+/* &&&&  solutions */
+
+/* forward and back substitution with the LU factors from triang_pole,
+applied to all of the lanes at once.  The factors are read in place, since
+this runs for every pole at every step. */
+
+static void solve_lanes (struct pole_lanes *pl)
+{
+	const gsl_matrix *lu = pl->pole->y;
+	const double *row;
+	double *x = pl->voltage + LANE (1);
+	const double *b = pl->injection + LANE (1);
+	const double *src;
+	double c;
+	int i, j, l, n = number_of_nodes;
+
+	for (i = 0; i < n; i++) {
+		src = b + LANE (pl->pole->perm->data [i]);
+		for (l = 0; l < width; l++) {
+			x [LANE (i) + l] = src [l];
+		}
+	}
+	for (i = 1; i < n; i++) {
+		row = lu->data + i * lu->tda;
+		for (j = 0; j < i; j++) {
+			c = row [j];
+			for (l = 0; l < width; l++) {
+				x [LANE (i) + l] -= c * x [LANE (j) + l];
+			}
+		}
+	}
+	for (i = n - 1; i >= 0; i--) {
+		row = lu->data + i * lu->tda;
+		for (j = i + 1; j < n; j++) {
+			c = row [j];
+			for (l = 0; l < width; l++) {
+				x [LANE (i) + l] -= c * x [LANE (j) + l];
+			}
+		}
+		c = row [i];
+		for (l = 0; l < width; l++) {
+			x [LANE (i) + l] /= c;
+		}
+	}
+}
+
+/* The compensation matrix 1 / y + Rthev is symmetric positive definite,
+so it is solved without pivoting. */
+
+static void solve_small (int m, double *a, double *b)
+{
+	int i, j, k;
+	double c;
+
+	for (k = 0; k < m; k++) {
+		for (i = k + 1; i < m; i++) {
+			c = a [i * m + k] / a [k * m + k];
+			for (j = k; j < m; j++) {
+				a [i * m + j] -= c * a [k * m + j];
+			}
+			b [i] -= c * b [k];
+		}
+	}
+	for (i = m - 1; i >= 0; i--) {
+		for (j = i + 1; j < m; j++) {
+			b [i] -= a [i * m + j] * b [j];
+		}
+		b [i] /= a [i * m + i];
+	}
+}
+
+static void compensate_lanes (struct pole_lanes *pl)
+{
+	struct switch_lanes *sw;
+	int a, b, m, l, node, ns = pl->num_switched, n = number_of_nodes;
+	double *v = pl->voltage;
+	double *z;
+
+	for (l = 0; l < width; l++) {
+		m = 0;
+		for (a = 0; a < ns; a++) {
+			if (switches [pl->switched [a]].conducting [l]) {
+				pl->on [m++] = a;
+			}
+		}
+		if (m < 1) {
+			continue;
+		}
+		for (a = 0; a < m; a++) {
+			sw = &switches [pl->switched [pl->on [a]]];
+			for (b = 0; b < m; b++) {
+				pl->work [a * m + b] = pl->rthev [pl->on [a] * ns + pl->on [b]];
+			}
+			pl->work [a * m + a] += 1.0 / sw->y;
+			pl->w [a] = v [LANE (sw->from) + l] - v [LANE (sw->to) + l];
+		}
+		solve_small (m, pl->work, pl->w);
+		for (a = 0; a < m; a++) {
+			z = pl->zcols + pl->on [a] * n;
+			for (node = 0; node < n; node++) {
+				v [LANE (node + 1) + l] -= z [node] * pl->w [a];
+			}
+		}
+	}
+}
+
+/* &&&&  switching checks, mirroring check_arrester and check_pipegap.  As in
+time_step_loops, a lane is solved again when one of its switches turns on,
+and all of its switches are checked again. */
+
+static void check_arrester_lanes (struct switch_lanes *sw, int *again)
+{
+	struct arrester *ptr = sw->arrester;
+	double *v = poles [sw->pole].voltage;
+	double volts, amps, vr, vl;
+	int l, pos_now;
+
+	for (l = 0; l < width; l++) {
+		if (!checking [l]) continue;
+		volts = v [LANE (sw->from) + l] - v [LANE (sw->to) + l];
+		pos_now = volts > 0.0;
+		if (sw->conducting [l]) {
+			amps = volts * sw->y + sw->i_past [l];
+			if (pos_now) {
+				vr = ptr->r_slope * (amps + sw->i_bias [l]);
+			} else {
+				vr = ptr->r_slope * (amps - sw->i_bias [l]);
+			}
+			sw->i_bias [l] = ptr->knee_bias;
+			vl = volts - vr;
+			sw->energy [l] += dT * amps * vr;
+			sw->charge [l] += dT * amps;
+			if (ptr->zl > 0.0) {
+				sw->h [l] = amps + vl / ptr->zl;
+			}
+			sw->i [l] = sw->h [l] * ptr->yzl;
+			if (pos_now) {
+				sw->i [l] -= ptr->yr * sw->i_bias [l];
+			} else {
+				sw->i [l] += ptr->yr * sw->i_bias [l];
+			}
+			if (fabs (amps) > fabs (sw->i_peak [l])) {
+				sw->i_peak [l] = amps;
+			}
+			if (fabs (vr) < ptr->v_knee) {
+				sw->conducting [l] = FALSE;
+				sw->h [l] = sw->i [l] = 0.0;
+			}
+		} else if (fabs (volts) > ptr->v_gap) {
+			sw->conducting [l] = TRUE;
+			sw->i_bias [l] = ptr->gap_bias;
+			if (pos_now) {
+				sw->i [l] = -ptr->yr * sw->i_bias [l];
+			} else {
+				sw->i [l] = ptr->yr * sw->i_bias [l];
+			}
+			sw->i_past [l] = sw->i [l];
+			again [l] = TRUE;
+		}
+	}
+}
+
+static void check_pipegap_lanes (struct switch_lanes *sw, int *again)
+{
+	struct pipegap *ptr = sw->pipegap;
+	double *v = poles [sw->pole].voltage;
+	double volts, amps;
+	int l;
+
+	for (l = 0; l < width; l++) {
+		if (!checking [l]) continue;
+		volts = v [LANE (sw->from) + l] - v [LANE (sw->to) + l];
+		if (sw->conducting [l]) {
+			amps = volts * sw->y + sw->i_past [l];
+			if (fabs (amps) > fabs (sw->i_peak [l])) {
+				sw->i_peak [l] = amps;
+			}
+			if (fabs (volts) < ptr->v_knee) {
+				sw->conducting [l] = FALSE;
+				sw->i_past [l] = 0.0;
+			}
+		} else if (fabs (volts) > ptr->v_knee) {
+			sw->conducting [l] = TRUE;
+			sw->i_past [l] = volts > 0.0 ? -ptr->i_bias : ptr->i_bias;
+			again [l] = TRUE;
+		}
+	}
+}
+
+static void solve_step (void)
+{
+	int again [MAX_LANES], any, i, l;
+
+	inject_common ();
+	for (l = 0; l < width; l++) {
+		checking [l] = live [l];
+	}
+	do {
+		inject_lanes ();
+		for (i = 0; i < num_poles; i++) {
+			if (poles [i].pole->solve) {
+				solve_lanes (&poles [i]);
+				if (poles [i].num_switched > 0) {
+					compensate_lanes (&poles [i]);
+				}
+			}
+		}
+		for (l = 0; l < width; l++) {
+			again [l] = FALSE;
+		}
+		for (i = 0; i < num_switches; i++) {
+			if (switches [i].arrester) {
+				check_arrester_lanes (&switches [i], again);
+			} else {
+				check_pipegap_lanes (&switches [i], again);
+			}
+		}
+		any = FALSE;
+		for (l = 0; l < width; l++) {
+			checking [l] = again [l];
+			if (again [l]) any = TRUE;
+		}
+	} while (any);
+}
+
+/* &&&&  history updates, mirroring the check_ and update_ functions */
+
+static void stop_lane (int l)
+{
+	live [l] = FALSE;
+	flashed [l] = TRUE;
+}
+
+static void update_ground_lanes (struct ground_lanes *gl)
+{
+	struct ground *ptr = gl->ground;
+	double *v = poles [gl->pole].voltage;
+	double It, Vt, Vg, Vl, Ri, i_bias;
+	int l;
+
+	for (l = 0; l < width; l++) {
+		Vt = v [LANE (ptr->from) + l] - v [LANE (ptr->to) + l];
+		It = Vt * ptr->y + gl->i [l];
+		Ri = ptr->R60 / sqrt (1.0 + fabs (It) / ptr->Ig);
+		Vg = It * Ri;
+		i_bias = Vg * (1.0 / Ri - ptr->y60);
+		Vl = Vt - Vg;
+		if (ptr->zl > 0.0) {
+			gl->h [l] = It + Vl / ptr->zl;
+		}
+		gl->i [l] = gl->h [l] * ptr->yzl + i_bias * ptr->yr;
+	}
+}
+
+static void update_insulator_lanes (struct insulator_lanes *il)
+{
+	struct insulator *ptr = il->insulator;
+	double *v = poles [il->pole].voltage;
+	double volts [MAX_LANES], rate [MAX_LANES], de_inc, pos;
+	int l;
+
+	for (l = 0; l < width; l++) {
+		volts [l] = v [LANE (ptr->from) + l] - v [LANE (ptr->to) + l];
+		rate [l] = live [l] ? fabs (volts [l]) - ptr->vb : 0.0;
+	}
+	de_rates (ptr->beta, width, rate);
+	for (l = 0; l < width; l++) {
+		if (!live [l]) continue;
+		de_inc = rate [l] * dT;
+		pos = volts [l] >= 0.0 ? 1.0 : 0.0;
+		il->de_pos [l] += de_inc * pos;
+		il->de_neg [l] += de_inc * (1.0 - pos);
+		if (il->de_pos [l] >= ptr->de_max || il->de_neg [l] >= ptr->de_max) {
+			stop_lane (l);
+		}
+	}
+}
+
+static void update_lpm_lanes (struct lpm_lanes *ml)
+{
+	struct lpm *ptr = ml->lpm;
+	double *v = poles [ml->pole].voltage;
+	double volts, ds, ds2, x, dx;
+	int l;
+
+	for (l = 0; l < width; l++) {
+		if (!live [l]) continue;
+		volts = v [LANE (ptr->from) + l] - v [LANE (ptr->to) + l];
+		if (fabs (volts) > ptr->v_quiet) {
+			ml->pts [l * lpm_steps + ml->npts [l]++] = (float) volts;
+		}
+		if (volts == 0.0) continue;  /* no voltage means no leader propagation */
+		x = volts > 0.0 ? ml->xpos [l] : ml->xneg [l];
+		ds = fabs (volts) * ptr->k * dT;
+		ds2 = ds * fabs (volts) / x;
+		ds *= ptr->e0;
+		dx = ds2 - ds;
+		if (volts > 0.0) {
+			if (dx > 0.0) ml->xpos [l] -= dx;
+			if (volts > ml->vpk_pos [l]) ml->vpk_pos [l] = volts;
+		} else {
+			if (dx > 0.0) ml->xneg [l] -= dx;
+			if (-volts > ml->vpk_neg [l]) ml->vpk_neg [l] = -volts;
+		}
+		if (ptr->flash_mode != LPM_DISABLE_FLASH && (ml->xpos [l] <= 0.0 || ml->xneg [l] <= 0.0)) {
+			stop_lane (l);
+		}
+	}
+}
+
+static void update_history_lanes (struct history_lanes *hl)
+{
+	double *v = poles [hl->pole].voltage;
+	int l;
+
+	for (l = 0; l < width; l++) {
+		hl->h [l] = hl->a * hl->h [l] + hl->b * (v [LANE (hl->from) + l] - v [LANE (hl->to) + l]);
+	}
+}
+
+/* vmode = T v, over the phase voltages of the lanes */
+
+static void transform_voltages (struct pole_lanes *pl, gsl_matrix *T)
+{
+	const double *row;
+	double *vm, c;
+	int r, i, l;
+
+	for (r = 0; r < (int) T->size1; r++) {
+		vm = pl->vmode + LANE (r);
+		row = T->data + r * T->tda;
+		for (l = 0; l < width; l++) {
+			vm [l] = 0.0;
+		}
+		for (i = 0; i < (int) T->size2; i++) {
+			c = row [i];
+			for (l = 0; l < width; l++) {
+				vm [l] += c * pl->voltage [LANE (i + 1) + l];
+			}
+		}
+	}
+}
+
+static void calc_vmode_lanes (struct pole_lanes *pl)
+{
+	double z;
+	int i, l;
+
+	if (pl->pole->solve) {
+		transform_voltages (pl, span_head->Tvt);
+	} else {
+		for (i = 0; i < number_of_conductors; i++) {
+			z = gsl_matrix_get (span_head->Zm, i, i);
+			for (l = 0; l < width; l++) {
+				pl->vmode [LANE (i) + l] = pl->imode [LANE (i) + l] * z * 0.5;
+			}
+		}
+	}
+}
+
+static void update_line_lanes (struct line_lanes *ll)
+{
+	double *vl, *vr, *hl, *hr, y, irl, ilr;
+	int i, k, l;
+
+	k = step % ll->line->steps;
+	for (i = 0; i < number_of_conductors; i++) {
+		y = gsl_matrix_get (ll->line->defn->Ym, i, i);
+		vl = poles [ll->left].vmode + LANE (i);
+		vr = poles [ll->right].vmode + LANE (i);
+		hl = ll->hist_left + LANE (i * ll->line->alloc_steps + k);
+		hr = ll->hist_right + LANE (i * ll->line->alloc_steps + k);
+		for (l = 0; l < width; l++) {
+			ilr = vl [l] * y + hl [l];
+			irl = vr [l] * y + hr [l];
+			hl [l] = -vr [l] * y - irl;
+			hr [l] = -vl [l] * y - ilr;
+		}
+	}
+}
+
+static void update_step (void)
+{
+	struct switch_lanes *sw;
+	int i, l;
+
+	for (i = 0; i < num_grounds; i++) {
+		update_ground_lanes (&grounds [i]);
+	}
+	for (i = 0; i < num_insulators; i++) {
+		update_insulator_lanes (&insulators [i]);
+	}
+	for (i = 0; i < num_lpms; i++) {
+		update_lpm_lanes (&lpms [i]);
+	}
+	for (i = 0; i < num_histories; i++) {
+		update_history_lanes (&histories [i]);
+	}
+	for (i = 0; i < num_switches; i++) {
+		sw = &switches [i];
+		if (sw->arrester) {
+			for (l = 0; l < width; l++) {
+				sw->i_past [l] = sw->i [l];
+			}
+		}
+	}
+	if (using_multiple_span_defns) {
+		for (i = 0; i < num_lines; i++) {
+			transform_voltages (&poles [lines [i].left], lines [i].line->defn->Tvt);
+			transform_voltages (&poles [lines [i].right], lines [i].line->defn->Tvt);
+			update_line_lanes (&lines [i]);
+		}
+	} else {
+		for (i = 0; i < num_poles; i++) {
+			calc_vmode_lanes (&poles [i]);
+		}
+		for (i = 0; i < num_lines; i++) {
+			update_line_lanes (&lines [i]);
+		}
+	}
+	while (width > 0 && !live [width - 1]) {
+		--width;
+	}
+}
+
+/* &&&&  answers, as the _answers_cleanup functions find them */
+
+static double lpm_lane_si (struct lpm_lanes *ml, int l)
+{
+	struct lpm *ptr = ml->lpm;
+	struct lpm saved = *ptr;
+	double si;
+
+	ptr->pts = ml->pts + l * lpm_steps;
+	ptr->npts = ml->npts [l];
+	ptr->xpos = ml->xpos [l];
+	ptr->xneg = ml->xneg [l];
+	ptr->vpk_pos = ml->vpk_pos [l];
+	ptr->vpk_neg = ml->vpk_neg [l];
+	if (want_si_calculation) {
+		si = calculate_lpm_si (ptr, 0.0);
+	} else {
+		si = estimate_lpm_si (ptr);
+	}
+	*ptr = saved;
+	return si;
+}
+
+static void lane_answers (int l, LPLTOUTSTRUCT answers)
+{
+	struct insulator *ptr;
+	struct switch_lanes *sw;
+	double si, highest_de;
+	int i;
+
+	answers->SI = answers->energy = answers->current = answers->charge = 0.0;
+	answers->predischarge = answers->dSI = 0.0;
+	if (flashed [l]) {
+		answers->SI = 1.0;
+	} else {
+		for (i = 0; i < num_insulators; i++) {
+			ptr = insulators [i].insulator;
+			highest_de = insulators [i].de_pos [l];
+			if (insulators [i].de_neg [l] > highest_de) {
+				highest_de = insulators [i].de_neg [l];
+			}
+			si = pow (highest_de / ptr->de_max, 1.0 / ptr->beta);
+			if (si > answers->SI) answers->SI = si;
+		}
+		for (i = 0; i < num_lpms; i++) {
+			si = lpm_lane_si (&lpms [i], l);
+			if (si > answers->SI) answers->SI = si;
+		}
+	}
+	for (i = 0; i < num_switches; i++) {
+		sw = &switches [i];
+		if (sw->arrester) {
+			if (sw->energy [l] > answers->energy) answers->energy = sw->energy [l];
+			if (fabs (sw->i_peak [l]) > fabs (answers->current)) answers->current = sw->i_peak [l];
+			if (fabs (sw->charge [l]) > fabs (answers->charge)) answers->charge = sw->charge [l];
+		} else if (fabs (sw->i_peak [l]) > fabs (answers->predischarge)) {
+			answers->predischarge = sw->i_peak [l];
+		}
+	}
+}
+
+/* simulate a stroke of each peak current in i_pk, as run_loop_case does
+one at a time.  The stroke is moved with the largest peak current, and the
+other lanes scale its waveshape. */
+
+void run_lockstep_cases (int pole_number, int wire_number, int lanes, double *i_pk,
+	double ftf, double ftt, LPLTOUTSTRUCT answers)
+{
+	struct pole *parent;
+	double top;
+	int i, l;
+
+	if (lanes > MAX_LANES) {
+		lanes = MAX_LANES;
+	}
+	top = i_pk [0];
+	for (l = 1; l < lanes; l++) {
+		if (i_pk [l] > top) top = i_pk [l];
+	}
+	reset_system ();
+	stroke_surge = surge_head->next;
+	stroke_steepfront = NULL;
+	if (stroke_surge) {
+		move_surge (stroke_surge, pole_number, wire_number, 0, top, ftf, ftt, 0.0);
+		parent = stroke_surge->parent;
+	} else {
+		stroke_steepfront = steepfront_head->next;
+		move_steepfront (stroke_steepfront, pole_number, wire_number,
+			0, top, ftf, ftt, 0.0, stroke_steepfront->pu_si);
+		parent = stroke_steepfront->parent;
+	}
+	do_all_poles (triang_pole);  /* the struck pole may not have been solved before */
+
+	build_poles ();
+	build_switches ();
+	for (i = 0; i < num_poles; i++) {
+		build_compensation (&poles [i]);
+	}
+	build_components ();
+	build_lines ();
+	stroke_pole = find_lane_pole (parent);
+	width = lanes;
+	for (l = 0; l < lanes; l++) {
+		peak [l] = i_pk [l];
+		live [l] = TRUE;
+		flashed [l] = FALSE;
+	}
+
+	t = 0.0;
+	step = 0;
+	do {
+		solve_step ();
+		update_step ();
+		t += dT;
+		++step;
+	} while (t <= Tmax && width > 0);
+
+	for (l = 0; l < lanes; l++) {
+		lane_answers (l, &answers [l]);
+	}
+	free_lanes ();
+}
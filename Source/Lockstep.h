@@ -0,0 +1,34 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef lockstep_included
+#define lockstep_included
+
+/* Several cases that differ only in the stroke peak current are simulated
+together, one lane per case.  Each lane gets the SI and arrester answers
+that run_loop_case would give it. */
+
+#define MAX_LANES 8
+
+int lockstep_supported (void);  /* FALSE if the model needs scalar runs */
+void run_lockstep_cases (int pole_number, int wire_number, int lanes, double *i_pk,
+	double ftf, double ftt, LPLTOUTSTRUCT answers);  /* answers has one entry per lane */
+
+#endif
@@ -0,0 +1,424 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This file contains functions to estimate the flashover probability and
+the arrester duty for random strokes.  The peak current, front time and
+charge are correlated lognormal variables from the Cigre statistics, the
+tail time follows from the charge as in icrit_function, and the struck pole
+and wire are uniform over the ones requested for critical currents.
+
+Importance sampling draws the independent standard normals behind the
+correlated variables from a shifted mean, toward higher currents and shorter
+fronts, and every sample carries the likelihood ratio of the two densities as
+its weight.  Latin hypercube sampling stratifies the uniforms behind all five
+random choices within each batch of MC_BATCH samples, so a run that stops at
+a batch boundary is still fully stratified.  Its confidence intervals use the
+variance of independent samples, which overstates the true variance.
+
+Sample k always draws from its own random stream, seeded from the run's seed
+and k, and the answers are tallied in sample order, so a run gives the same
+results for any number of workers.  Each of W worker processes takes every W-th
+sample.  With arresters in the model, the samples that flash over still
+run to Tmax, so the arrester energy statistics include their full duty. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_cdf.h>
+
+#include "OETypes.h"
+#include "OEEngine.h"
+#include "SpatialWindow.h"
+#include "MonteCarlo.h"
+#include "Workers.h"
+#include "AllComponents.h"
+
+#define MC_BATCH        100    /* samples between progress reports and stopping checks */
+#define MC_MIN_FLASHES   10    /* flashovers needed before stopping on the relative error */
+#define MC_Z95         1.96    /* for 95% confidence intervals */
+#define MC_MIN_TAIL     2.0    /* shortest tail, per unit of the front, that move_surge accepts */
+#define MC_BINS          35    /* arrester energy histogram, 5 bins per decade from 1 J */
+#define MC_BINS_PER_DECADE 5
+#define MC_DIMENSIONS     5    /* current, front, charge, pole and wire */
+
+struct stroke_statistics {
+	double i_median, i_beta;
+	double t_median, t_beta;
+	double q_median, q_beta;
+};
+
+/* the estimates are weighted sums over the samples */
+struct mc_totals {
+	int samples;
+	int flashes;
+	double sum_flash, sum_flash2;
+	double sum_energy, sum_energy2;
+	double histogram [MC_BINS + 2];  /* with underflow and overflow bins */
+};
+
+static struct stroke_statistics stats;
+static double chol [3][3];  /* Cholesky factor of the correlation matrix */
+static double shift [3];  /* importance sampling mean of the independent normals */
+static double shift_square;
+static int latin_hypercube;
+static int strata [MC_DIMENSIONS][MC_BATCH];
+static int strata_batch = -1;
+static int wires [MAX_WIRES_HIT];
+static int number_of_wires;
+static int first_pole, last_pole;
+static int use_window;
+static unsigned long seed;
+static gsl_rng *rng = NULL;
+
+static void set_statistics (int subsequent, double i_shift, double t_shift)
+{
+	if (subsequent) {
+		stats.i_median = 1000.0 * I_MEDIAN_SUBS;
+		stats.i_beta = I_BETA_SUBS;
+		stats.t_median = 1.0e-6 * T3090_SUBS;
+		stats.t_beta = T3090_BETA_SUBS;
+		stats.q_median = Q_MEDIAN_SUBS;
+		stats.q_beta = Q_BETA_SUBS;
+	} else {
+		stats.i_median = 1000.0 * I_MEDIAN_FIRST;
+		stats.i_beta = I_BETA_FIRST;
+		stats.t_median = 1.0e-6 * T3090_FIRST;
+		stats.t_beta = T3090_BETA_FIRST;
+		stats.q_median = Q_MEDIAN_FIRST;
+		stats.q_beta = Q_BETA_FIRST;
+	}
+	memset (chol, 0, sizeof chol);
+	chol[0][0] = 1.0;
+	chol[1][0] = RHO_I_T3090;
+	chol[1][1] = sqrt (1.0 - RHO_I_T3090 * RHO_I_T3090);
+	chol[2][0] = RHO_I_Q;
+	chol[2][1] = (RHO_T3090_Q - RHO_I_Q * RHO_I_T3090) / chol[1][1];
+	chol[2][2] = sqrt (1.0 - chol[2][0] * chol[2][0] - chol[2][1] * chol[2][1]);
+/* shift the log current up by i_shift and the log front down by t_shift,
+in standard deviations, leaving the charge to follow its correlations */
+	shift[0] = i_shift;
+	shift[1] = (-t_shift - chol[1][0] * shift[0]) / chol[1][1];
+	shift[2] = 0.0;
+	shift_square = shift[0] * shift[0] + shift[1] * shift[1];
+}
+
+/* one random permutation of the strata per dimension, for the batch that
+holds sample k */
+
+static void set_strata (int k)
+{
+	int batch = k / MC_BATCH;
+	int d, i, j, tmp;
+
+	if (batch == strata_batch) {
+		return;
+	}
+	strata_batch = batch;
+	gsl_rng_set (rng, ~seed ^ (2654435761UL * (unsigned long) (batch + 1)));
+	for (d = 0; d < MC_DIMENSIONS; d++) {
+		for (i = 0; i < MC_BATCH; i++) {
+			strata[d][i] = i;
+		}
+		for (i = MC_BATCH - 1; i > 0; i--) {
+			j = (int) gsl_rng_uniform_int (rng, i + 1);
+			tmp = strata[d][i];
+			strata[d][i] = strata[d][j];
+			strata[d][j] = tmp;
+		}
+	}
+}
+
+/* sample k reseeds the generator, so it never depends on which samples
+the same process drew before */
+
+static void draw_stroke (struct stroke_sample *s, int k)
+{
+	double u [MC_DIMENSIONS], z [3], zc [3], zdot;
+	int i, j;
+
+	if (latin_hypercube) {
+		set_strata (k);
+	}
+	gsl_rng_set (rng, seed ^ (2654435761UL * (unsigned long) (k + 1)));
+	for (i = 0; i < MC_DIMENSIONS; i++) {
+		u[i] = gsl_rng_uniform_pos (rng);
+		if (latin_hypercube) {
+			u[i] = (strata[i][k % MC_BATCH] + u[i]) / MC_BATCH;
+		}
+	}
+	zdot = 0.0;
+	for (i = 0; i < 3; i++) {
+		z[i] = gsl_cdf_ugaussian_Pinv (u[i]) + shift[i];
+		zdot += shift[i] * z[i];
+	}
+	for (i = 0; i < 3; i++) {
+		zc[i] = 0.0;
+		for (j = 0; j <= i; j++) {
+			zc[i] += chol[i][j] * z[j];
+		}
+	}
+	memset (s, 0, sizeof *s);
+	s->index = k;
+	s->weight = exp (0.5 * shift_square - zdot);
+	s->i_pk = stats.i_median * exp (stats.i_beta * zc[0]);
+	s->ftf = stats.t_median * exp (stats.t_beta * zc[1]);
+	s->ftt = stats.q_median * exp (stats.q_beta * zc[2]) / s->i_pk / ETKONST;
+	if (s->ftt < MC_MIN_TAIL * s->ftf) {
+		s->ftt = MC_MIN_TAIL * s->ftf;
+	}
+	s->pole_number = first_pole + (int) (u[3] * (last_pole - first_pole + 1));
+	if (s->pole_number > last_pole) s->pole_number = last_pole;
+	i = (int) (u[4] * number_of_wires);
+	s->wire_number = wires [i < number_of_wires ? i : number_of_wires - 1];
+}
+
+static void simulate_sample (struct stroke_sample *s, int k, LPLTOUTSTRUCT answers)
+{
+	int windowed = FALSE;
+
+	draw_stroke (s, k);
+	move_insulators (s->pole_number);
+	if (use_window) {
+		windowed = open_spatial_window (s->pole_number);
+	}
+	run_loop_case (s->pole_number, s->wire_number, s->i_pk, s->ftf, s->ftt, answers, 0.0);
+	if (windowed) {
+		close_spatial_window ();
+	}
+	s->SI = answers->SI;
+	s->energy = answers->energy;
+	s->current = answers->current;
+	s->charge = answers->charge;
+	s->flashover = (answers->SI >= 1.0);
+}
+
+static void tally_sample (struct mc_totals *tot, struct stroke_sample *s)
+{
+	double wf, we;
+	int bin;
+
+	++tot->samples;
+	wf = 0.0;
+	if (s->flashover) {
+		++tot->flashes;
+		wf = s->weight;
+	}
+	we = s->weight * s->energy;
+	tot->sum_flash += wf;
+	tot->sum_flash2 += wf * wf;
+	tot->sum_energy += we;
+	tot->sum_energy2 += we * we;
+	if (s->energy < 1.0) {
+		bin = 0;
+	} else {
+		bin = 1 + (int) (MC_BINS_PER_DECADE * log10 (s->energy));
+		if (bin > MC_BINS + 1) bin = MC_BINS + 1;
+	}
+	tot->histogram [bin] += s->weight;
+	if (op) {
+		fprintf (op, "%6d %4d %4d %8.3f %7.3f %8.3f %10.4e %10.4e %d %10.4e\n", s->index + 1,
+			s->pole_number, s->wire_number, 0.001 * s->i_pk, 1.0e6 * s->ftf, 1.0e6 * s->ftt,
+			s->SI, s->energy, s->flashover, s->weight);
+	}
+}
+
+/* weighted mean of a sample quantity, with the half-width of its
+confidence interval */
+
+static double estimate (int n, double sum, double sum2, double *half_width)
+{
+	double mean = sum / n;
+	double var = 0.0;
+
+	if (n > 1) {
+		var = (sum2 - n * mean * mean) / (n - 1);
+	}
+	*half_width = var > 0.0 ? MC_Z95 * sqrt (var / n) : 0.0;
+	return mean;
+}
+
+static double flash_probability (struct mc_totals *tot, double *half_width)
+{
+	return estimate (tot->samples, tot->sum_flash, tot->sum_flash2, half_width);
+}
+
+static int converged (struct mc_totals *tot, double rel_error)
+{
+	double p, hw;
+
+	if (rel_error <= 0.0 || tot->flashes < MC_MIN_FLASHES) {
+		return FALSE;
+	}
+	p = flash_probability (tot, &hw);
+	return hw <= rel_error * p;
+}
+
+static void report_progress (struct mc_totals *tot)
+{
+	double p, hw;
+
+	p = flash_probability (tot, &hw);
+	printf ("%6d samples, %5d flashovers, P = %.4e +/- %.2e\n", tot->samples, tot->flashes, p, hw);
+	fflush (stdout);
+	if (logfp) {
+		fprintf (logfp, "Monte Carlo: %d samples, %d flashovers, P = %G +/- %G\n",
+			tot->samples, tot->flashes, p, hw);
+		fflush (logfp);
+	}
+}
+
+static void report_totals (struct mc_totals *tot, LPLTOUTSTRUCT answers)
+{
+	double p, hw, mean, ehw, cum;
+	int i;
+
+	p = flash_probability (tot, &hw);
+	mean = estimate (tot->samples, tot->sum_energy, tot->sum_energy2, &ehw);
+	answers->samples = tot->samples;
+	answers->p_flash = p;
+	answers->p_flash_ci = hw;
+	answers->energy = mean;
+	if (!op) {
+		return;
+	}
+	fprintf (op, "\nMonte Carlo summary, %d samples\n", tot->samples);
+	fprintf (op, "flashovers: %d, probability %.4e, 95%% interval %.4e to %.4e\n",
+		tot->flashes, p, p - hw, p + hw);
+	fprintf (op, "arrester energy: mean %.4e J, 95%% interval %.4e to %.4e J\n",
+		mean, mean - ehw, mean + ehw);
+	if (!arrester_head->next && !arrbez_head->next) {
+		return;
+	}
+	fprintf (op, "arrester energy histogram\n");
+	fprintf (op, "   from [J]     to [J]     P(bin)  P(exceed from)\n");
+	cum = 0.0;
+	for (i = 0; i < MC_BINS + 2; i++) {
+		cum += tot->histogram[i];
+	}
+	for (i = 0; i < MC_BINS + 2; i++) {
+		if (tot->histogram[i] > 0.0) {
+			fprintf (op, " %10.3e %10.3e %10.4e %10.4e\n",
+				i > 0 ? pow (10.0, (i - 1.0) / MC_BINS_PER_DECADE) : 0.0,
+				i <= MC_BINS ? pow (10.0, (double) i / MC_BINS_PER_DECADE) : HUGE_VAL,
+				tot->histogram[i] / tot->samples, cum / tot->samples);
+		}
+		cum -= tot->histogram[i];
+	}
+}
+
+static struct monte_carlo_job {
+	int samples;
+	LPLTOUTSTRUCT answers;
+} job;
+
+static void run_worker (int w, int workers, void *data)
+{
+	struct monte_carlo_job *j = (struct monte_carlo_job *) data;
+	struct stroke_sample s;
+	int k;
+
+	for (k = w; k < j->samples; k += workers) {
+		simulate_sample (&s, k, j->answers);
+		send_to_parent (&s, sizeof s);
+	}
+}
+
+void monte_carlo (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers)
+{
+	struct mc_totals tot;
+	struct stroke_sample s;
+	int samples, workers, k;
+
+	answers->samples = 0;
+	answers->p_flash = answers->p_flash_ci = 0.0;
+	number_of_wires = 0;
+	for (k = 0; k < MAX_WIRES_HIT; k++) {
+		answers->icritical[k] = 0.0;
+		if (lt_input->wire_struck[k] > 0) wires[number_of_wires++] = k + 1;
+	}
+	if (number_of_wires < 1 || (!surge_head->next && !steepfront_head->next)) {
+		if (logfp) fprintf (logfp, "Monte Carlo runs need a surge or steepfront, and a struck wire\n");
+		return;
+	}
+	first_pole = lt_input->first_pole_hit;
+	last_pole = lt_input->last_pole_hit;
+	use_window = lt_input->use_window;
+	seed = lt_input->seed;
+	samples = lt_input->samples;
+	set_statistics (lt_input->subsequent, lt_input->i_shift, lt_input->t_shift);
+	latin_hypercube = lt_input->latin_hypercube;
+	strata_batch = -1;
+/* arresters keep absorbing energy after a flashover, so their energy
+statistics need every sample to run to Tmax */
+	if (arrester_head->next || arrbez_head->next) {
+		flash_halt_enabled = FALSE;
+	}
+	if (!(rng = gsl_rng_alloc (gsl_rng_mt19937))) {
+		if (logfp) fprintf (logfp, "can't allocate Monte Carlo random numbers\n");
+		oe_exit (ERR_MATH_ALLOC);
+	}
+	workers = count_workers (lt_input->workers, samples);
+	if (logfp) {
+		fprintf (logfp, "Monte Carlo: %d samples, seed %lu, %d workers, relative error %G\n",
+			samples, seed, workers, lt_input->rel_error);
+		fprintf (logfp, "current shift %G, front shift %G, Latin hypercube %d\n",
+			lt_input->i_shift, lt_input->t_shift, latin_hypercube);
+		fprintf (logfp, "%s\n", flash_halt_enabled ? "samples stop at a flashover" :
+			"samples run to Tmax after a flashover, for the arrester energy");
+	}
+	if (op) {
+		fprintf (op, "sample pole wire   I [kA] tf [us]  tt [us]         SI energy [J] flash     weight\n");
+	}
+	memset (&tot, 0, sizeof tot);
+
+	if (workers > 1) {
+		job.samples = samples;
+		job.answers = answers;
+		start_workers (workers, run_worker, &job);
+	}
+	for (k = 0; k < samples; k++) {
+		if (workers > 1) {
+			receive_from_worker (k % workers, &s, sizeof s);
+		} else {
+			simulate_sample (&s, k, answers);
+		}
+		tally_sample (&tot, &s);
+		if ((k + 1) % MC_BATCH == 0) {
+			report_progress (&tot);
+			if (converged (&tot, lt_input->rel_error)) {
+				if (logfp) fprintf (logfp, "Monte Carlo stopped at the requested relative error\n");
+				break;
+			}
+		}
+	}
+	if (workers > 1) {
+		stop_workers ();
+	}
+	if (tot.samples % MC_BATCH != 0) {
+		report_progress (&tot);
+	}
+	report_totals (&tot, answers);
+	gsl_rng_free (rng);
+	rng = NULL;
+}
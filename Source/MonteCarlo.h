@@ -0,0 +1,64 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef montecarlo_included
+#define montecarlo_included
+
+/* Cigre lightning stroke parameters: medians of the charge in C, the peak
+current in kA and the 30-90% front time in us, and the standard deviations
+of their natural logarithms */
+#define Q_MEDIAN_FIRST  4.65
+#define I_MEDIAN_FIRST 31.10
+#define T3090_FIRST     3.83
+#define Q_MEDIAN_SUBS   0.938
+#define I_MEDIAN_SUBS  12.30
+#define T3090_SUBS      0.67
+
+#define Q_BETA_FIRST    0.883
+#define I_BETA_FIRST    0.484
+#define T3090_BETA_FIRST 0.553
+#define Q_BETA_SUBS     0.882
+#define I_BETA_SUBS     0.530
+#define T3090_BETA_SUBS 1.013
+
+/* correlation coefficients between the logarithms, used for both strokes */
+#define RHO_I_T3090     0.47
+#define RHO_I_Q         0.77
+#define RHO_T3090_Q     0.31
+
+/* one Monte Carlo stroke and the answers from simulating it */
+struct stroke_sample {
+	int index;        /* sample number, which also selects its random stream */
+	int pole_number;
+	int wire_number;
+	int flashover;    /* TRUE if SI reached 1 */
+	double weight;    /* likelihood ratio for importance sampling, otherwise 1 */
+	double i_pk;      /* peak current in A */
+	double ftf;       /* front time in s */
+	double ftt;       /* tail time in s */
+	double SI;
+	double energy;
+	double current;
+	double charge;
+};
+
+void monte_carlo (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers);
+
+#endif
@@ -1,485 +1,1031 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-/* This module contains the time-step loop and supporting functions for
-LPDW's transient simulation engine, based on H. W. Dommel's IEEE papers.
-Called from the driver and xfmr modules. */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include <time.h>
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_matrix.h>
-#include <gsl/gsl_blas.h>
-#include <gsl/gsl_linalg.h>
-#include <gsl/gsl_roots.h>
-
-#include "OETypes.h"
-#include "OERead.h"
-#include "OEEngine.h"
-#include "ChangeTimeStep.h"
-#include "Components/Meter.h"
-#include "WritePlotFile.h"
-#include "AllComponents.h"
-
-/* Cigre lightning stroke parameters */
-#define Q_MEDIAN_FIRST  4.65
-#define I_MEDIAN_FIRST 31.10
-#define T3090_FIRST     3.83
-#define Q_MEDIAN_SUBS   0.938
-#define I_MEDIAN_SUBS  12.30
-#define T3090_SUBS      0.67
-
-#define MIN_STROKE 3.0e3
-#define MAX_STROKE 500.0e3
-#define MAX_ITER 200
-#define ITER_TOL 1.0
-
-#undef LOG_POLES_AND_LINES
-#undef LOG_ARRBEZ
-
-/* definitions for externs in ltengine.h */
-
-char *sp;
-char *sn;
-
-int header_stop[3] = {0, 0, 0};
-
-int using_network;  /* used time, span, and line tokens */
-int using_multiple_span_defns;
-int number_of_nodes;
-int number_of_conductors;
-int number_of_poles;
-
-double span_length;
-double dT;
-double Tmax;
-double t;
-int step;
-int solution_valid;
-int left_end_z;
-int right_end_z;
-
-gsl_vector_int *poles_used;
-gsl_matrix_int *pairs_used;
-
-double predischarge;  /* maximum predischarge current in pipegaps */
-double SI, energy, current, charge; /* maximum insulator severity index, and
-	maximum arrester energy, current, and charge, of all components in the simulation */
-int flash_halt, flash_halt_enabled; /* flags to stop simulation if an insulator flashes over */
-int want_si_calculation;  /* set 1 for solution by bisection, 0 for an estimate */
-
-int gi_iteration_mode;
-
-/* main simulation function */
-
-int lt (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers)
-{
-	unsigned int bytes = 0;
-	int i, j;
-	
-	gi_iteration_mode = lt_input->iteration_mode;
-
-	if (lt_input->fp) { /* input comes from a file */
-		sp = sn = (char *) malloc (BUFFER_LENGTH);
-		bytes = fread (sn, 1, BUFFER_LENGTH_LESS_1, lt_input->fp);
-		sn [bytes] = '\0';
-	} else {
-		if (logfp) fprintf( logfp, "No input available for lt simulation\n");
-		oe_exit (ERR_BUFFER_MISSING);
-	}
-	op = lt_input->op; /* text output */
-	bp = lt_input->bp; /* plot file */
-	if (lt_input->stop_on_flashover) {
-		flash_halt_enabled = TRUE;
-	} else {
-		flash_halt_enabled = FALSE;
-	}
-	if (gi_iteration_mode == ONE_SHOT) {
-		want_si_calculation = TRUE;
-	} else {
-		want_si_calculation = TRUE; /* need SI when iterating for critical current */
-	}
-/* set up head pointers for the linked lists */
-	(void) init_surge_list ();
-	(void) init_source_list ();
-	(void) init_meter_list ();
-	(void) init_pole_list ();
-	(void) init_span_list ();
-	(void) init_line_list ();
-	(void) init_ground_list ();
-	(void) init_resistor_list ();
-	(void) init_inductor_list ();
-	(void) init_capacitor_list ();
-	(void) init_customer_list ();
-	(void) init_insulator_list ();
-	(void) init_arrester_list ();
-	(void) init_pipegap_list ();
-	(void) init_lpm_list ();
-	(void) init_arrbez_list ();
-	(void) init_steepfront_list ();
-/* read input from either the file or the memory buffer */
-	(void) readfile ();
-	if (op && (gi_iteration_mode == ONE_SHOT)) { /* DOS only */
-		fprintf (op, "  N   span     dT   Tmax\n");
-		fprintf (op, "%3d %6.2f %.4g %.4g\n", 
-			number_of_nodes, span_length, dT, Tmax);
-		fprintf (op, "Z-phase\n");
-		for (i = 0; i < number_of_nodes; i++) {
-			for (j = 0; j < number_of_nodes; j++) {
-				fprintf (op, " %14.5e", gsl_matrix_get (span_head->Zp, i, j));
-			}
-			fprintf (op, "\n");
-		}
-		fprintf (op, "Z-modal\n");
-		for (i = 0; i < number_of_nodes; i++) {
-			for (j = 0; j < number_of_nodes; j++) {
-				fprintf (op, " %14.5e", gsl_matrix_get (span_head->Zm, i, j));
-			}
-			fprintf (op, "\n");
-		}
-		fprintf (op, "Modal Transformation (Ti)\n");
-		for (i = 0; i < number_of_nodes; i++) {
-			for (j = 0; j < number_of_nodes; j++) {
-				fprintf (op, " %14.5e", gsl_matrix_get (span_head->Ti, i, j));
-			}
-			fprintf (op, "\n");
-		}
-	}
-/* complete set-up of the system model, with past history currents for
-storage elements */
-	if (!using_network) {
-		connect_lines ();
-	}
-	do_all_lines (init_line_history);
-	do_all_inductors (init_inductor_history);
-	do_all_capacitors (init_capacitor_history);
-/* make sure we solve for voltages at each end of the circuit, and add
-surge impedance terminations */
-	pole_ptr = find_pole (1);
-	if (pole_ptr) {
-		pole_ptr->solve = TRUE;
-		if (left_end_z) {
-			terminate_pole (pole_ptr, span_head);
-		}
-	}
-	pole_ptr = find_pole (number_of_poles);
-	if (pole_ptr) {
-		pole_ptr->solve = TRUE;
-		if (right_end_z) {
-			terminate_pole (pole_ptr, span_head);
-		}
-	}
-	if (op && (gi_iteration_mode == ONE_SHOT)) {
-		do_all_sources (print_source_data);
-	}
-/* perform initial y matrix factoring at each pole - now ready to start */
-	do_all_poles (triang_pole);
-	Tmax += 0.5 * dT;
-/* there are three running modes for the transient simulation: */
-	if (gi_iteration_mode == FIND_CRITICAL_CURRENT) {
-/* critical flashover current iteration - as called by driver */
-		if (logfp) fprintf( logfp, "lt in location control mode\n");
-		loop_control (lt_input, answers);
-	} else {
-/* single-shot run, as called by the DOS version */
-		if (logfp) fprintf( logfp, "lt in stand-alone mode\n");
-		time_step_loops (answers);
-	}
-	if (op) { /* print results, DOS only */
-		if (logfp) fprintf( logfp, "\n");
-		if (gi_iteration_mode == ONE_SHOT) {
-			do_all_meters (print_meter_data);
-			do_all_insulators (print_insulator_data);
-			do_all_lpms (print_lpm_data);
-			do_all_customers (print_customer_data);
-			do_all_arresters (print_arrester_data);
-			do_all_arrbezs (print_arrbez_data);
-			do_all_pipegaps (print_pipegap_data);
-		} else {
-			fprintf (op, "\nAverage Critical Currents, Poles %d to %d\n", 
-				lt_input->first_pole_hit, lt_input->last_pole_hit);
-			for (i = 0; i < MAX_WIRES_HIT; ++i) {
-				if (lt_input->wire_struck[i] > 0) {
-					fprintf (op, "wire %2d: %4e\n", i+1, answers->icritical[i]); 
-				}
-			}
-		}
-	}
-	if (op) {
-		fprintf (op, "nr_iter = %ld, nr_max = %d\n", nr_iter, nr_max);
-	} else if (logfp) {
-		fprintf (logfp, "nr_iter = %ld, nr_max = %d\n", nr_iter, nr_max);
-	}
-	(void) cleanup ();
-	return (0);
-}
-
-void run_loop_case (int pole_number, int wire_number, double i_pk, double ftf, double ftt, 
-					LPLTOUTSTRUCT answers)
-{
-	reset_system ();  /* reset initial conditions for each simulation */
-	surge_ptr = surge_head->next;
-	steepfront_ptr = steepfront_head->next;
-/* re-set the surge component parameters */
-	if (surge_ptr) {
-		move_surge (surge_ptr, pole_number, wire_number, 0, i_pk, ftf, ftt, 0.0);
-	} else if (steepfront_ptr) {
-		move_steepfront (steepfront_ptr, pole_number, wire_number, 
-			0, i_pk, ftf, ftt, 0.0, steepfront_ptr->pu_si);
-	}
-/* run the transient simulation */
-	time_step_loops (answers);
-}
-
-double icrit_function (double i_pk, void *params)
-{
-	struct icrit_params *p = (struct icrit_params *) params;
-	double ftt = Q_MEDIAN_FIRST / I_MEDIAN_FIRST / 1000.0 / ETKONST; 
-	double ftf = 1.0e-6 * T3090_FIRST;
-	double ret;
-
-	run_loop_case (p->pole_number, p->wire_number, i_pk, ftf, ftt, p->answers);
-	ret = p->answers->SI - 1.0;
-	if (ret >= 0.0) {
-		ret += (Tmax - t) * 1.0e5;
-	}
-
-	return ret;
-}
-
-/* this function simulates a stroke to each pole and exposed wire,
-at each histogram midpoint value */
-
-void loop_control (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers)
-{
-	int wire_idx, pole_number, wire_number;
-	int case_number, wires_hit;
-	int insulators_at_one_pole, first_ins_pole;
-	double num_poles;
-	int has_arresters;
-
-	struct icrit_params params;
-	const gsl_root_fsolver_type *T;
-	gsl_root_fsolver *s;
-	gsl_function F;
-	double i_pk, i_lo, i_hi;
-	int status, iter;
-
-/* set up the GSL root finder */
-	F.function = &icrit_function;
-	F.params = &params;
-	T = gsl_root_fsolver_brent;
-	s = gsl_root_fsolver_alloc (T);
-
-/* zero out the answer arrays */
-	wires_hit = 0;
-	for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
-		answers->icritical[wire_idx] = 0.0;
-		if (lt_input->wire_struck[wire_idx] > 0) ++wires_hit;
-	}
-	
-	has_arresters = FALSE;
-	if (arrbez_head->next) has_arresters = TRUE;
-	if (arrester_head->next) has_arresters = TRUE;
-	if (logfp) fprintf (logfp, "has_arresters = %d\n", has_arresters);
-
-	num_poles = lt_input->last_pole_hit - lt_input->first_pole_hit + 1.0;
-
-	case_number = 0;
-	params.answers = answers;
-/* check all of the requested poles */
-	for (pole_number = lt_input->first_pole_hit; pole_number <= lt_input->last_pole_hit; pole_number++) {
-		params.pole_number = pole_number;
-/*  if there are insulators at just one pole, we want to move them with
-    the surge.  If insulators at more than one pole, leave them in place.
-    First, look through the insulators for presence of different poles: */
-		insulators_at_one_pole = TRUE;
-		first_ins_pole = 0;
-		insulator_ptr = insulator_head;
-		while ((insulator_ptr = insulator_ptr->next) != NULL) {
-			if (first_ins_pole == 0) {
-				first_ins_pole =
-					insulator_ptr->parent->location;
-			}
-			if (first_ins_pole!=insulator_ptr->parent->location) {
-				insulators_at_one_pole = FALSE;
-			}
-		}
-		lpm_ptr = lpm_head;
-		while ((lpm_ptr = lpm_ptr->next) != NULL) {
-			if (first_ins_pole == 0) {
-				first_ins_pole = lpm_ptr->parent->location;
-			}
-			if (first_ins_pole!=lpm_ptr->parent->location) {
-				insulators_at_one_pole = FALSE;
-			}
-		}
-/*  Now move the insulators if only one insulator pole was found */
-		if (insulators_at_one_pole == TRUE) {
-			insulator_ptr = insulator_head;
-			while ((insulator_ptr = insulator_ptr->next) != NULL) {
-				move_insulator (insulator_ptr, pole_number);
-			}
-			lpm_ptr = lpm_head;
-			while ((lpm_ptr = lpm_ptr->next) != NULL) {
-				move_lpm (lpm_ptr, pole_number);
-			}
-		}
-/* check all of the exposed conductors at this pole.  The set of exposed
-conductors was originally determined in egm, passed in by driver */
-		for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
-			if (lt_input->wire_struck[wire_idx] > 0) {
-				wire_number = wire_idx + 1;
-				params.wire_number = wire_number;
-				iter = 0;
-				status = GSL_SUCCESS;
-				if (icrit_function (MIN_STROKE, &params) >= 0.0) { /* always have a flashover */
-					answers->icritical[wire_idx] += (MIN_STROKE / num_poles);
-				} else if (icrit_function (MAX_STROKE, &params) <= 0.0) { /* never have a flashover */
-					answers->icritical[wire_idx] += (MAX_STROKE / num_poles);
-				} else { /* iterate for critical current */
-					gsl_root_fsolver_set (s, &F, MIN_STROKE, MAX_STROKE);
-					do {
-						++iter;
-						status = gsl_root_fsolver_iterate (s);
-						i_pk = gsl_root_fsolver_root (s);
-						i_lo = gsl_root_fsolver_x_lower (s);
-						i_hi = gsl_root_fsolver_x_upper (s);
-						status = gsl_root_test_interval (i_lo, i_hi, ITER_TOL, 0.0);
-						if (status == GSL_SUCCESS) {
-							answers->icritical[wire_idx] += (i_pk / num_poles);
-						}
-					} while (status == GSL_CONTINUE && iter < MAX_ITER);
-				}
-				++case_number;
-				if (logfp) {
-					fprintf (logfp, "case %d, pole %d, wire %d, i_pk = %G, ftf = %G, ftt = %G, SI = %G, Energy = %G, iter = %d, status = %d\n",
-						case_number, pole_number, wire_number, 0.001 * answers->icritical[wire_idx], T3090_FIRST, 
-						1000.0 * Q_MEDIAN_FIRST / I_MEDIAN_FIRST / ETKONST, 
-						answers->SI, answers->energy, iter, status);
-					fflush (logfp);
-				}
-			}
-		}
-	}
-	gsl_root_fsolver_free (s);
-}
-
-/* run a complete simulation, assuming the initial conditions have been
-set properly */
-
-void time_step_loops (LPLTOUTSTRUCT answers)
-{
-	t = 0.0;
-	step = 0;
-	flash_halt = FALSE;
-	if (op) {
-//		printf ("%le <- Tmax\n", Tmax);
-//		printf ("%le <- Time Now\r", t);
-	}
-	if (bp) {  /* initialize plot file */
-		InitializePlotOutput (meter_head, dT, Tmax);
-	}
-	do_all_monitors (find_monitor_links);
-	do { /* keep going till we hit Tmax, or an insulator flashes over when flash_halt_enabled */
-		solution_valid = FALSE;
-		while (!solution_valid) { /* get a valid solution for this step - no arrester state changes */
-/* solve for voltages at this step */
-			do_all_poles (zero_pole_injection);
-			do_all_surges (inject_surge);
-			do_all_steepfronts (inject_steepfront);
-			do_all_sources (inject_source);
-			do_all_grounds (inject_ground);
-			if (using_multiple_span_defns) {
-				do_all_lines (inject_line_iphase);
-			} else {
-				do_all_lines (inject_line_imode);
-				do_all_poles (inject_pole_imode);
-			}
-			do_all_arresters (inject_arrester);
-			do_all_pipegaps (inject_pipegap);
-			do_all_inductors (inject_inductor_history);
-			do_all_capacitors (inject_capacitor_history);
-			do_all_poles (triang_pole);
-			do_all_poles (solve_pole);
-			solution_valid = TRUE; /* see if an arrester changed state - need to resolve */
-			do_all_arresters (check_arrester);
-			do_all_pipegaps (check_pipegap);
-		}
-/* update the non-linear and energy-storage history terms for the next step */
-		do_all_grounds (check_ground);
-		do_all_insulators (check_insulator);  /* may set flash_halt */
-		do_all_lpms (check_lpm);
-		do_all_inductors (update_inductor_history);
-		do_all_arresters (update_arrester_history);
-		do_all_arrbezs (update_arrbez_history);
-		do_all_capacitors (update_capacitor_history);
-		do_all_customers (update_customer_history);
-		if (using_multiple_span_defns) {
-			do_all_lines (update_vmode_and_history);
-		} else {
-			do_all_poles (calc_pole_vmode);
-			do_all_lines (update_line_history);
-		}
-		if (bp) {  
-			WritePlotTimeStep (meter_head, t);
-		} else {
-			do_all_meters (update_meter_peaks);
-		}
-		do_all_monitors (update_monitor_pts);
-#ifdef LOG_POLES_AND_LINES
-		do_all_poles (print_pole_data);
-		do_all_lines (print_line_history);
-#endif
-		if (op) {  /* progress report */
-			if (step % 10 == 0) {
-//				printf ("%le\r", t);
-			}
-		}
-		if (using_second_dT && !dT_switched) {
-			if (t >= dT_switch_time) {
-				change_time_step();
-			}
-		}
-		t += dT;  /* advance the time step */
-		++step;
-	} while (t <= Tmax && !flash_halt);
-	if (logfp) fprintf( logfp, "\n");
-/* set up "quick answers" for DOS version */
-	SI = energy = charge = current = predischarge = 0.0;
-	do_all_arresters (arrester_answers_cleanup);
-	do_all_pipegaps (pipegap_answers_cleanup);
-	do_all_insulators (insulator_answers_cleanup);
-	do_all_lpms (lpm_answers_cleanup);
-	do_all_arrbezs (arrbez_answers_cleanup);
-	answers->SI = SI; /* severity index for insulator closest to flashing over */
-	answers->energy = energy;  /* highest arrester discharge parameters */
-	answers->charge = charge;
-	answers->current = current;
-	answers->predischarge = predischarge;
-	do_all_monitors (update_monitor_summary);
-	if (bp) {
-		FinalizePlotHeader (t, step);
-	}
-}
-
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This module contains the time-step loop and supporting functions for
+LPDW's transient simulation engine, based on H. W. Dommel's IEEE papers.
+Called from the driver and xfmr modules. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+#include <gsl/gsl_roots.h>
+
+#include "OETypes.h"
+#include "OERead.h"
+#include "OEEngine.h"
+#include "ChangeTimeStep.h"
+#include "SpatialWindow.h"
+#include "Sensitivity.h"
+#include "Lockstep.h"
+#include "MonteCarlo.h"
+#include "Workers.h"
+#include "Components/Meter.h"
+#include "WritePlotFile.h"
+#include "AllComponents.h"
+
+#define MIN_STROKE 3.0e3
+#define MAX_STROKE 500.0e3
+#define MAX_ITER 200
+#define ITER_TOL 1.0
+#define SI_PRECISION 0.01  /* relative accuracy of SI - 1 for the Brent and seeded searches */
+#define SHORT_STEP 0.05  /* Newton step, per unit of the current it starts from */
+#define PREDICTION_SPREAD 0.1  /* first spread of lockstep cases, per unit of the predicted current */
+#define SEED_SPREAD 0.1  /* first case below a seeded critical current, per unit */
+
+#undef LOG_POLES_AND_LINES
+#undef LOG_ARRBEZ
+
+/* definitions for externs in ltengine.h */
+
+char *sp;
+char *sn;
+
+int header_stop[3] = {0, 0, 0};
+
+int using_network;  /* used time, span, and line tokens */
+int using_multiple_span_defns;
+int number_of_nodes;
+int number_of_conductors;
+int number_of_poles;
+
+double span_length;
+double dT;
+double Tmax;
+double t;
+int step;
+int solution_valid;
+int left_end_z;
+int right_end_z;
+
+gsl_vector_int *poles_used;
+gsl_matrix_int *pairs_used;
+
+double predischarge;  /* maximum predischarge current in pipegaps */
+double SI, energy, current, charge; /* maximum insulator severity index, and
+	maximum arrester energy, current, and charge, of all components in the simulation */
+int flash_halt, flash_halt_enabled; /* flags to stop simulation if an insulator flashes over */
+int want_si_calculation;  /* set 1 for solution by bisection, 0 for an estimate */
+double si_precision;  /* LPM SI accuracy that time_step_loops was asked for, 0 for full */
+
+int gi_iteration_mode;
+
+/* read the whole input stream into one buffer, however long it is */
+
+static char *read_input (FILE *fp)
+{
+	char *buf;
+	size_t size, bytes, got;
+
+	size = BUFFER_LENGTH;
+	bytes = 0;
+	if ((buf = (char *) malloc (size)) == NULL) {
+		if (logfp) fprintf (logfp, "can't allocate input buffer\n");
+		oe_exit (ERR_MALLOC);
+	}
+	while ((got = fread (buf + bytes, 1, size - 1 - bytes, fp)) > 0) {
+		bytes += got;
+		if (bytes == size - 1) {
+			size *= 2;
+			if ((buf = (char *) realloc (buf, size)) == NULL) {
+				if (logfp) fprintf (logfp, "can't grow input buffer to %lu bytes\n", (unsigned long) size);
+				oe_exit (ERR_MALLOC);
+			}
+		}
+	}
+	buf [bytes] = '\0';
+	return (buf);
+}
+
+/* main simulation function */
+
+int lt (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers)
+{
+	int i, j;
+	struct pole *pole;
+	FILE *fp;
+	
+	gi_iteration_mode = lt_input->iteration_mode;
+
+	if (lt_input->fp) { /* input comes from a file */
+		sp = sn = read_input (lt_input->fp);
+	} else {
+		if (logfp) fprintf( logfp, "No input available for lt simulation\n");
+		oe_exit (ERR_BUFFER_MISSING);
+	}
+	op = lt_input->op; /* text output */
+	bp = lt_input->bp; /* plot file */
+	if (lt_input->stop_on_flashover) {
+		flash_halt_enabled = TRUE;
+	} else {
+		flash_halt_enabled = FALSE;
+	}
+	want_sensitivity = FALSE;
+	if (gi_iteration_mode == FIND_CRITICAL_CURRENT && lt_input->use_newton) {
+		if (implicit_grounds || substep_switching) {  /* the tangents follow the step-boundary models */
+			if (logfp) fprintf (logfp, "Newton steps can't be used with implicit grounds or substep timing, so the root finder is used\n");
+		} else {
+			want_sensitivity = TRUE;
+		}
+	}
+	if (gi_iteration_mode == ONE_SHOT) {
+		want_si_calculation = TRUE;
+	} else {
+		want_si_calculation = TRUE; /* need SI when iterating for critical current */
+	}
+/* set up head pointers for the linked lists */
+	(void) init_surge_list ();
+	(void) init_source_list ();
+	(void) init_meter_list ();
+	(void) init_pole_list ();
+	(void) init_span_list ();
+	(void) init_line_list ();
+	(void) init_ground_list ();
+	(void) init_resistor_list ();
+	(void) init_inductor_list ();
+	(void) init_capacitor_list ();
+	(void) init_customer_list ();
+	(void) init_insulator_list ();
+	(void) init_arrester_list ();
+	(void) init_pipegap_list ();
+	(void) init_lpm_list ();
+	(void) init_arrbez_list ();
+	(void) init_steepfront_list ();
+/* read input from either the file or the memory buffer */
+	(void) readfile ();
+	if (op && (gi_iteration_mode == ONE_SHOT)) { /* DOS only */
+		fprintf (op, "  N   span     dT   Tmax\n");
+		fprintf (op, "%3d %6.2f %.4g %.4g\n", 
+			number_of_nodes, span_length, dT, Tmax);
+		fprintf (op, "Z-phase\n");
+		for (i = 0; i < number_of_nodes; i++) {
+			for (j = 0; j < number_of_nodes; j++) {
+				fprintf (op, " %14.5e", gsl_matrix_get (span_head->Zp, i, j));
+			}
+			fprintf (op, "\n");
+		}
+		fprintf (op, "Z-modal\n");
+		for (i = 0; i < number_of_nodes; i++) {
+			for (j = 0; j < number_of_nodes; j++) {
+				fprintf (op, " %14.5e", gsl_matrix_get (span_head->Zm, i, j));
+			}
+			fprintf (op, "\n");
+		}
+		fprintf (op, "Modal Transformation (Ti)\n");
+		for (i = 0; i < number_of_nodes; i++) {
+			for (j = 0; j < number_of_nodes; j++) {
+				fprintf (op, " %14.5e", gsl_matrix_get (span_head->Ti, i, j));
+			}
+			fprintf (op, "\n");
+		}
+	}
+/* complete set-up of the system model, with past history currents for
+storage elements */
+	if (!using_network) {
+		connect_lines ();
+	}
+	do_all_lines (init_line_history);
+	do_all_inductors (init_inductor_history);
+	do_all_capacitors (init_capacitor_history);
+/* make sure we solve for voltages at each end of the circuit, and add
+surge impedance terminations */
+	pole_ptr = find_pole (1);
+	if (pole_ptr) {
+		pole_ptr->solve = TRUE;
+		if (left_end_z) {
+			terminate_pole (pole_ptr, span_head);
+		}
+	}
+	pole_ptr = find_pole (number_of_poles);
+	if (pole_ptr) {
+		pole_ptr->solve = TRUE;
+		if (right_end_z) {
+			terminate_pole (pole_ptr, span_head);
+		}
+	}
+	if (op && (gi_iteration_mode == ONE_SHOT)) {
+		do_all_sources (print_source_data);
+	}
+/* perform initial y matrix factoring at each pole - now ready to start */
+	do_all_poles (triang_pole);
+	Tmax += 0.5 * dT;
+/* move_surge ignores the front and tail times of a measured shape */
+	if (logfp && surge_head->next && surge_head->next->record &&
+		(gi_iteration_mode == MONTE_CARLO || lt_input->fronts > 0)) {
+		fprintf (logfp, "surgewave keeps its measured shape, only its peak is varied\n");
+	}
+/* there are three running modes for the transient simulation: */
+	if (gi_iteration_mode == FIND_CRITICAL_CURRENT) {
+/* critical flashover current iteration - as called by driver */
+		if (logfp) fprintf( logfp, "lt in location control mode\n");
+		if (lt_input->fronts > 0) {
+			icrit_curves (lt_input, answers);
+		} else {
+			loop_control (lt_input, answers);
+		}
+	} else if (gi_iteration_mode == MONTE_CARLO) {
+		if (logfp) fprintf( logfp, "lt in Monte Carlo mode\n");
+		monte_carlo (lt_input, answers);
+	} else {
+/* single-shot run, as called by the DOS version */
+		if (logfp) fprintf( logfp, "lt in stand-alone mode\n");
+		time_step_loops (answers, 0.0);
+	}
+	if (op) { /* print results, DOS only */
+		if (logfp) fprintf( logfp, "\n");
+		if (gi_iteration_mode == ONE_SHOT) {
+			do_all_meters (print_meter_data);
+			do_all_insulators (print_insulator_data);
+			do_all_lpms (print_lpm_data);
+			do_all_customers (print_customer_data);
+			do_all_arresters (print_arrester_data);
+			do_all_arrbezs (print_arrbez_data);
+			do_all_pipegaps (print_pipegap_data);
+		} else if (gi_iteration_mode == FIND_CRITICAL_CURRENT && lt_input->fronts > 0) {
+			fprintf (op, "\nAverage Critical Currents versus Front Time, Poles %d to %d\n",
+				lt_input->first_pole_hit, lt_input->last_pole_hit);
+			for (j = 0; j < answers->fronts; j++) {
+				fprintf (op, "tf %8.3f us:", 1.0e6 * answers->front[j]);
+				for (i = 0; i < MAX_WIRES_HIT; ++i) {
+					if (lt_input->wire_struck[i] > 0) {
+						fprintf (op, " %4e", answers->icurve[j][i]);
+					}
+				}
+				fprintf (op, "\n");
+			}
+		} else if (gi_iteration_mode == FIND_CRITICAL_CURRENT) {
+			fprintf (op, "\nAverage Critical Currents, Poles %d to %d\n", 
+				lt_input->first_pole_hit, lt_input->last_pole_hit);
+			for (i = 0; i < MAX_WIRES_HIT; ++i) {
+				if (lt_input->wire_struck[i] > 0) {
+					fprintf (op, "wire %2d: %4e\n", i+1, answers->icritical[i]); 
+				}
+			}
+		}
+	}
+	fp = op ? op : logfp;
+	if (fp) {
+		fprintf (fp, "nr_iter = %ld, nr_max = %d\n", nr_iter, nr_max);
+		for (pole = pole_head->next; pole; pole = pole->next) {
+			if (pole->nr_iter > 0) {
+				fprintf (fp, "\tpole %d: nr_iter = %ld, nr_max = %d\n",
+					pole->location, pole->nr_iter, pole->nr_max);
+			}
+		}
+	}
+	(void) cleanup ();
+	return (0);
+}
+
+void run_loop_case (int pole_number, int wire_number, double i_pk, double ftf, double ftt, 
+					LPLTOUTSTRUCT answers, double precision)
+{
+	reset_system ();  /* reset initial conditions for each simulation */
+	surge_ptr = surge_head->next;
+	steepfront_ptr = steepfront_head->next;
+/* re-set the surge component parameters */
+	if (surge_ptr) {
+		move_surge (surge_ptr, pole_number, wire_number, 0, i_pk, ftf, ftt, 0.0);
+	} else if (steepfront_ptr) {
+		move_steepfront (steepfront_ptr, pole_number, wire_number, 
+			0, i_pk, ftf, ftt, 0.0, steepfront_ptr->pu_si);
+	}
+/* run the transient simulation */
+	time_step_loops (answers, precision);
+}
+
+double icrit_function (double i_pk, void *params)
+{
+	struct icrit_params *p = (struct icrit_params *) params;
+	double ret;
+
+	run_loop_case (p->pole_number, p->wire_number, i_pk, p->ftf, p->ftt, p->answers, p->si_precision);
+	ret = p->answers->SI - 1.0;
+	if (ret >= 0.0) {
+		ret += (Tmax - t) * 1.0e5;
+	}
+
+	return ret;
+}
+
+/* Newton iteration for the critical current, starting from the MIN_STROKE
+simulation just run, which did not flash over.  SI - 1 is smooth below the
+critical current, but the early flashover penalty makes icrit_function jump
+there, so the steps are always taken from the highest current without a
+flashover, using dSI/dI_pk.  The change in dSI between the last two such
+points adds a curvature term, which keeps the steps from overshooting much.
+When a short step does overshoot, the root is usually just below it, so that
+is tried next.  Otherwise the root stays bracketed with bisection, and
+MAX_STROKE is simulated only if a step reaches it. */
+
+static int newton_icrit (struct icrit_params *p, double *root, int *iter)
+{
+	double x, f, x_lo, f_lo, df_lo, x_hi, curv, disc;
+	int hi_checked = FALSE;
+	int new_lo = TRUE;  /* FALSE if the last step from x_lo flashed over */
+	int short_step = FALSE;
+
+	x_lo = MIN_STROKE;
+	f_lo = p->answers->SI - 1.0;
+	df_lo = p->answers->dSI;
+	x_hi = MAX_STROKE;
+	curv = 0.0;
+	while (*iter < MAX_ITER) {
+		++(*iter);
+		x = x_hi;
+		if (df_lo > 0.0 && new_lo) {
+			disc = df_lo * df_lo - 2.0 * curv * f_lo;
+			if (disc > 0.0) {
+				x = x_lo - 2.0 * f_lo / (df_lo + sqrt (disc));
+			} else {
+				x = x_lo - f_lo / df_lo;
+			}
+			if (x - x_lo < ITER_TOL) {
+				*root = x;
+				return GSL_SUCCESS;
+			}
+			if (hi_checked && fabs (x - x_hi) < ITER_TOL) {
+				*root = x < x_hi ? x : x_hi;
+				return GSL_SUCCESS;
+			}
+			short_step = (x - x_lo < SHORT_STEP * x_lo);
+		} else if (short_step) {
+			x = x_hi - ITER_TOL;
+			short_step = FALSE;
+		}
+		if (x >= x_hi || x <= x_lo) {
+			x = hi_checked ? 0.5 * (x_lo + x_hi) : x_hi;
+		}
+		if (x_hi - x_lo < ITER_TOL) {
+			*root = 0.5 * (x_lo + x_hi);
+			return GSL_SUCCESS;
+		}
+		f = icrit_function (x, p);
+		if (f <= 0.0 && x >= MAX_STROKE) { /* never have a flashover */
+			*root = MAX_STROKE;
+			return GSL_SUCCESS;
+		}
+		if (p->answers->SI < 1.0) {
+			curv = (p->answers->dSI - df_lo) / (x - x_lo);
+			x_lo = x;
+			f_lo = f;
+			df_lo = p->answers->dSI;
+			new_lo = TRUE;
+		} else {
+			x_hi = x;
+			hi_checked = TRUE;
+			new_lo = FALSE;
+		}
+	}
+	return GSL_CONTINUE;
+}
+
+/* Search for the critical current with the cases of each pass simulated in
+lockstep.  Below the critical current, SI is smooth and nearly proportional
+to the peak current, so the root is predicted from the highest case without
+flashover, or by the secant through the two highest.  The cases are spread
+around the prediction, as far as it moved on the last pass, and the lowest
+flashover and the case below it bracket the root for the next pass.  Without
+a useful prediction, the bracket is divided evenly.  The first pass also
+simulates MAX_STROKE, in case there is never a flashover. */
+
+static int lockstep_icrit (struct icrit_params *p, int lanes, double *root, int *iter)
+{
+	LTOUTSTRUCT lane_answers [MAX_LANES];
+	double x [MAX_LANES];
+	double x_lo, si_lo, x_below, si_below, x_hi, r, r_last, spread, dx, first;
+	int hi_checked = FALSE;
+	int i, n;
+
+	x_lo = MIN_STROKE;
+	si_lo = p->answers->SI;
+	x_below = si_below = 0.0;  /* next highest case without flashover, if any */
+	x_hi = MAX_STROKE;
+	r_last = 0.0;
+	while (*iter < MAX_ITER) {
+		if (x_hi - x_lo < ITER_TOL) {
+			*root = 0.5 * (x_lo + x_hi);
+			return GSL_SUCCESS;
+		}
+		++(*iter);
+		n = hi_checked ? lanes : lanes - 1;
+		r = 0.0;
+		if (x_below > 0.0 && si_lo > si_below) {
+			r = x_lo + (1.0 - si_lo) * (x_lo - x_below) / (si_lo - si_below);
+		} else if (si_lo > 0.0) {
+			r = x_lo / si_lo;
+		}
+		spread = r_last > 0.0 ? fabs (r - r_last) : PREDICTION_SPREAD * r;
+		dx = 2.0 * spread / (n + 1);
+		if (dx < 0.1 * ITER_TOL) dx = 0.1 * ITER_TOL;
+		if (n < 1 || r <= x_lo || r >= x_hi || dx * (n + 1) >= x_hi - x_lo) {
+			dx = (x_hi - x_lo) / (n + 1);  /* divide the bracket evenly */
+			first = x_lo + dx;
+		} else {  /* center the cases on r, but keep them inside the bracket */
+			first = r - 0.5 * (n - 1) * dx;
+			if (first <= x_lo) first = x_lo + 0.5 * dx;
+			if (first + (n - 1) * dx >= x_hi) first = x_hi - 0.5 * dx - (n - 1) * dx;
+		}
+		r_last = r;
+		for (i = 0; i < n; i++) {
+			x[i] = first + i * dx;
+		}
+		if (!hi_checked) {
+			x[n++] = MAX_STROKE;
+		}
+		run_lockstep_cases (p->pole_number, p->wire_number, n, x, p->ftf, p->ftt, lane_answers);
+		for (i = 0; i < n; i++) {
+			if (lane_answers[i].SI >= 1.0) {
+				break;
+			}
+			x_below = x_lo;
+			si_below = si_lo;
+			x_lo = x[i];
+			si_lo = lane_answers[i].SI;
+			p->answers->SI = lane_answers[i].SI;
+			p->answers->energy = lane_answers[i].energy;
+			p->answers->current = lane_answers[i].current;
+			p->answers->charge = lane_answers[i].charge;
+			p->answers->predischarge = lane_answers[i].predischarge;
+		}
+		if (i < n) {
+			x_hi = x[i];
+		} else if (!hi_checked) { /* never have a flashover */
+			*root = MAX_STROKE;
+			return GSL_SUCCESS;
+		}
+		hi_checked = TRUE;
+	}
+	return GSL_CONTINUE;
+}
+
+/* Search for the critical current near a seed, usually the critical current
+at the neighbouring front time.  The first case goes just below the seed, and
+cases that flash over before any case without flashover step down by halves.
+Above the highest case without flashover, the root is predicted as in
+lockstep_icrit, and the next case goes just above the prediction, so that a
+good prediction is confirmed by a flashover and then by a case ITER_TOL below
+it.  Predictions outside the bracket fall back to bisection. */
+
+static int seeded_icrit (struct icrit_params *p, double seed, double *root, int *iter)
+{
+	double x, x_lo, si_lo, x_below, si_below, x_hi;
+	int predicted;
+	int closing = FALSE;  /* TRUE after a predicted case flashed over */
+
+	x_lo = si_lo = 0.0;  /* highest case without flashover, once there is one */
+	x_below = si_below = 0.0;
+	x_hi = 0.0;  /* lowest case with flashover, once there is one */
+	*iter = 0;
+	p->si_precision = SI_PRECISION;
+	while (*iter < MAX_ITER) {
+		if (x_lo > 0.0 && x_hi > 0.0 && x_hi - x_lo < ITER_TOL) {
+			*root = 0.5 * (x_lo + x_hi);
+			return GSL_SUCCESS;
+		}
+		predicted = FALSE;
+		if (x_lo <= 0.0) {
+			x = x_hi > 0.0 ? 0.5 * x_hi : (1.0 - SEED_SPREAD) * seed;
+		} else if (closing) {
+			x = x_hi - ITER_TOL;
+		} else {
+			if (x_below > 0.0 && si_lo > si_below) {
+				x = x_lo + (1.0 - si_lo) * (x_lo - x_below) / (si_lo - si_below);
+			} else if (si_lo > 0.0) {
+				x = x_lo / si_lo;
+			} else {
+				x = (1.0 + SEED_SPREAD) * x_lo;
+			}
+			x += 0.5 * ITER_TOL;
+			predicted = TRUE;
+			if (x <= x_lo) x = (1.0 + SEED_SPREAD) * x_lo;
+			if (x_hi > 0.0 && x >= x_hi) {  /* the points below are too far away */
+				x = x_hi - SEED_SPREAD * (x_hi - x_lo);
+				if (x > x_hi - ITER_TOL) x = x_hi - ITER_TOL;
+				predicted = FALSE;
+			}
+		}
+		if (x_hi > 0.0 && (x >= x_hi || x <= x_lo)) {
+			x = 0.5 * (x_lo + x_hi);
+		}
+		if (x < MIN_STROKE) x = MIN_STROKE;
+		if (x > MAX_STROKE) x = MAX_STROKE;
+		++(*iter);
+		(void) icrit_function (x, p);
+		if (p->answers->SI < 1.0) {
+			if (x >= MAX_STROKE) { /* never have a flashover */
+				*root = MAX_STROKE;
+				return GSL_SUCCESS;
+			}
+			x_below = x_lo;
+			si_below = si_lo;
+			x_lo = x;
+			si_lo = p->answers->SI;
+			closing = FALSE;
+		} else {
+			if (x <= MIN_STROKE) { /* always have a flashover */
+				*root = MIN_STROKE;
+				return GSL_SUCCESS;
+			}
+			x_hi = x;
+			closing = predicted;
+		}
+	}
+	return GSL_CONTINUE;
+}
+
+/* critical current for one stroke location and waveshape, without a seed */
+
+static int find_icrit (struct icrit_params *p, int lanes, double *root, int *iter)
+{
+	gsl_root_fsolver *s;
+	gsl_function F;
+	double i_lo, i_hi;
+	int status;
+
+	*iter = 0;
+	p->si_precision = 0.0;  /* newton_icrit and lockstep_icrit need the full SI here */
+	if (icrit_function (MIN_STROKE, p) >= 0.0) { /* always have a flashover */
+		*root = MIN_STROKE;
+		return GSL_SUCCESS;
+	}
+	if (want_sensitivity) {
+		return newton_icrit (p, root, iter);
+	}
+	if (lanes > 1) {
+		return lockstep_icrit (p, lanes, root, iter);
+	}
+	if (icrit_function (MAX_STROKE, p) <= 0.0) { /* never have a flashover */
+		*root = MAX_STROKE;
+		return GSL_SUCCESS;
+	}
+/* iterate for critical current with the GSL root finder */
+	F.function = &icrit_function;
+	F.params = p;
+	s = gsl_root_fsolver_alloc (gsl_root_fsolver_brent);
+	p->si_precision = SI_PRECISION;
+	gsl_root_fsolver_set (s, &F, MIN_STROKE, MAX_STROKE);
+	do {
+		++(*iter);
+		status = gsl_root_fsolver_iterate (s);
+		*root = gsl_root_fsolver_root (s);
+		i_lo = gsl_root_fsolver_x_lower (s);
+		i_hi = gsl_root_fsolver_x_upper (s);
+		status = gsl_root_test_interval (i_lo, i_hi, ITER_TOL, 0.0);
+	} while (status == GSL_CONTINUE && *iter < MAX_ITER);
+	gsl_root_fsolver_free (s);
+	return status;
+}
+
+static int usable_lanes (LPLTINSTRUCT lt_input)
+{
+	int lanes = lt_input->lanes;
+
+	if (lanes > MAX_LANES) lanes = MAX_LANES;
+	if (lanes > 1 && !lockstep_supported ()) {
+		if (logfp) fprintf (logfp, "lockstep cases can't be used with this model, so they are run one at a time\n");
+		lanes = 1;
+	}
+	return lanes;
+}
+
+/*  if there are insulators at just one pole, we want to move them with
+    the surge.  If insulators at more than one pole, leave them in place.
+    First, look through the insulators for presence of different poles: */
+
+void move_insulators (int pole_number)
+{
+	int insulators_at_one_pole, first_ins_pole;
+
+	insulators_at_one_pole = TRUE;
+	first_ins_pole = 0;
+	insulator_ptr = insulator_head;
+	while ((insulator_ptr = insulator_ptr->next) != NULL) {
+		if (first_ins_pole == 0) {
+			first_ins_pole =
+				insulator_ptr->parent->location;
+		}
+		if (first_ins_pole!=insulator_ptr->parent->location) {
+			insulators_at_one_pole = FALSE;
+		}
+	}
+	lpm_ptr = lpm_head;
+	while ((lpm_ptr = lpm_ptr->next) != NULL) {
+		if (first_ins_pole == 0) {
+			first_ins_pole = lpm_ptr->parent->location;
+		}
+		if (first_ins_pole!=lpm_ptr->parent->location) {
+			insulators_at_one_pole = FALSE;
+		}
+	}
+/*  Now move the insulators if only one insulator pole was found */
+	if (insulators_at_one_pole == TRUE) {
+		insulator_ptr = insulator_head;
+		while ((insulator_ptr = insulator_ptr->next) != NULL) {
+			move_insulator (insulator_ptr, pole_number);
+		}
+		lpm_ptr = lpm_head;
+		while ((lpm_ptr = lpm_ptr->next) != NULL) {
+			move_lpm (lpm_ptr, pole_number);
+		}
+	}
+}
+
+/* this function simulates a stroke to each pole and exposed wire,
+at each histogram midpoint value */
+
+void loop_control (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers)
+{
+	int wire_idx, pole_number, wire_number;
+	int case_number, wires_hit;
+	int windowed;
+	int lanes;
+	double num_poles;
+	int has_arresters;
+
+	struct icrit_params params;
+	double i_pk;
+	int status, iter;
+
+/* zero out the answer arrays */
+	wires_hit = 0;
+	for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+		answers->icritical[wire_idx] = 0.0;
+		if (lt_input->wire_struck[wire_idx] > 0) ++wires_hit;
+	}
+	
+	has_arresters = FALSE;
+	if (arrbez_head->next) has_arresters = TRUE;
+	if (arrester_head->next) has_arresters = TRUE;
+	if (logfp) fprintf (logfp, "has_arresters = %d\n", has_arresters);
+
+	num_poles = lt_input->last_pole_hit - lt_input->first_pole_hit + 1.0;
+	lanes = usable_lanes (lt_input);
+
+	case_number = 0;
+	params.answers = answers;
+	params.si_precision = 0.0;
+	params.ftf = 1.0e-6 * T3090_FIRST;
+	params.ftt = Q_MEDIAN_FIRST / I_MEDIAN_FIRST / 1000.0 / ETKONST;
+/* check all of the requested poles */
+	for (pole_number = lt_input->first_pole_hit; pole_number <= lt_input->last_pole_hit; pole_number++) {
+		params.pole_number = pole_number;
+		move_insulators (pole_number);
+/* drop the poles that this stroke can't reach */
+		windowed = FALSE;
+		if (lt_input->use_window) {
+			windowed = open_spatial_window (pole_number);
+		}
+/* check all of the exposed conductors at this pole.  The set of exposed
+conductors was originally determined in egm, passed in by driver */
+		for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+			if (lt_input->wire_struck[wire_idx] > 0) {
+				wire_number = wire_idx + 1;
+				params.wire_number = wire_number;
+				status = find_icrit (&params, lanes, &i_pk, &iter);
+				if (status == GSL_SUCCESS) {
+					answers->icritical[wire_idx] += (i_pk / num_poles);
+				}
+				++case_number;
+				if (logfp) {
+					fprintf (logfp, "case %d, pole %d, wire %d, i_pk = %G, ftf = %G, ftt = %G, SI = %G, Energy = %G, iter = %d, status = %d\n",
+						case_number, pole_number, wire_number, 0.001 * answers->icritical[wire_idx], T3090_FIRST, 
+						1000.0 * Q_MEDIAN_FIRST / I_MEDIAN_FIRST / ETKONST, 
+						answers->SI, answers->energy, iter, status);
+					fflush (logfp);
+				}
+			}
+		}
+		if (windowed) {
+			close_spatial_window ();
+		}
+	}
+}
+
+/* Critical current curves over a grid of front times, with the tail time
+of icrit_function.  Each critical current seeds the search at the next
+front time.  The grid is cut into one contiguous piece per worker, and only
+the first front of each piece, or a front after a failed search, is searched
+without a seed.  A failed search leaves a zero, which is logged and left out
+of the average curve. */
+
+struct curve_job {
+	LPLTINSTRUCT lt_input;
+	LPLTOUTSTRUCT answers;
+	int lanes;
+	int fronts;
+	int workers;
+	double ftf [MAX_FRONTS];
+	double icrit [MAX_WIRES_HIT][MAX_FRONTS];
+	int iter [MAX_WIRES_HIT][MAX_FRONTS];
+};
+
+static struct curve_job curve_job;
+
+static void front_piece (struct curve_job *j, int w, int *first, int *last)
+{
+	*first = w * j->fronts / j->workers;
+	*last = (w + 1) * j->fronts / j->workers;
+}
+
+static void pole_curves (struct curve_job *j, int pole_number, int first, int last)
+{
+	struct icrit_params params;
+	double seed;
+	int wire_idx, k, status, windowed;
+
+	move_insulators (pole_number);
+	windowed = FALSE;
+	if (j->lt_input->use_window) {
+		windowed = open_spatial_window (pole_number);
+	}
+	params.answers = j->answers;
+	params.si_precision = 0.0;
+	params.pole_number = pole_number;
+	params.ftt = Q_MEDIAN_FIRST / I_MEDIAN_FIRST / 1000.0 / ETKONST;
+	for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+		if (j->lt_input->wire_struck[wire_idx] > 0) {
+			params.wire_number = wire_idx + 1;
+			for (k = first; k < last; k++) {
+				params.ftf = j->ftf[k];
+				if (k == first || j->icrit[wire_idx][k-1] <= 0.0) {
+					status = find_icrit (&params, j->lanes, &j->icrit[wire_idx][k], &j->iter[wire_idx][k]);
+				} else {
+					seed = j->icrit[wire_idx][k-1];
+					if (k - 1 > first && j->icrit[wire_idx][k-2] > 0.0) {  /* the grid is geometric */
+						seed *= seed / j->icrit[wire_idx][k-2];
+					}
+					status = seeded_icrit (&params, seed, &j->icrit[wire_idx][k], &j->iter[wire_idx][k]);
+				}
+				if (status != GSL_SUCCESS) {
+					j->icrit[wire_idx][k] = 0.0;
+				}
+			}
+		}
+	}
+	if (windowed) {
+		close_spatial_window ();
+	}
+}
+
+static void curve_worker (int w, int workers, void *data)
+{
+	struct curve_job *j = (struct curve_job *) data;
+	int pole_number, wire_idx, first, last;
+
+	front_piece (j, w, &first, &last);
+	for (pole_number = j->lt_input->first_pole_hit; pole_number <= j->lt_input->last_pole_hit; pole_number++) {
+		pole_curves (j, pole_number, first, last);
+		for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+			if (j->lt_input->wire_struck[wire_idx] > 0) {
+				send_to_parent (&j->icrit[wire_idx][first], (last - first) * sizeof (double));
+				send_to_parent (&j->iter[wire_idx][first], (last - first) * sizeof (int));
+			}
+		}
+	}
+}
+
+void icrit_curves (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers)
+{
+	struct curve_job *j = &curve_job;
+	int pole_number, wire_idx, k, w, first, last, runs, failed;
+	int found [MAX_FRONTS][MAX_WIRES_HIT];
+	double ratio;
+
+	j->lt_input = lt_input;
+	j->answers = answers;
+	j->lanes = usable_lanes (lt_input);
+	j->fronts = lt_input->fronts;
+	if (j->fronts > MAX_FRONTS) j->fronts = MAX_FRONTS;
+	ratio = 1.0;
+	if (j->fronts > 1) {
+		ratio = pow (lt_input->front_max / lt_input->front_min, 1.0 / (j->fronts - 1));
+	}
+	for (k = 0; k < j->fronts; k++) {
+		j->ftf[k] = 1.0e-6 * lt_input->front_min * pow (ratio, k);
+		answers->front[k] = j->ftf[k];
+		for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+			answers->icurve[k][wire_idx] = 0.0;
+			found[k][wire_idx] = 0;
+		}
+	}
+	for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+		answers->icritical[wire_idx] = 0.0;
+	}
+	answers->fronts = j->fronts;
+	j->workers = count_workers (lt_input->workers, j->fronts);
+	if (logfp) fprintf (logfp, "critical current curves at %d front times, %d workers\n", j->fronts, j->workers);
+	if (j->workers > 1) {
+		start_workers (j->workers, curve_worker, j);
+	}
+	runs = failed = 0;
+	for (pole_number = lt_input->first_pole_hit; pole_number <= lt_input->last_pole_hit; pole_number++) {
+		if (j->workers > 1) {
+			for (w = 0; w < j->workers; w++) {
+				front_piece (j, w, &first, &last);
+				for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+					if (lt_input->wire_struck[wire_idx] > 0) {
+						receive_from_worker (w, &j->icrit[wire_idx][first], (last - first) * sizeof (double));
+						receive_from_worker (w, &j->iter[wire_idx][first], (last - first) * sizeof (int));
+					}
+				}
+			}
+		} else {
+			pole_curves (j, pole_number, 0, j->fronts);
+		}
+		if (op) {
+			fprintf (op, "\nCritical current [kA] versus front time [us], pole %d\nwire", pole_number);
+			for (k = 0; k < j->fronts; k++) {
+				fprintf (op, " %8.3f", 1.0e6 * j->ftf[k]);
+			}
+			fprintf (op, "\n");
+		}
+		for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+			if (lt_input->wire_struck[wire_idx] > 0) {
+				if (op) fprintf (op, "%4d", wire_idx + 1);
+				for (k = 0; k < j->fronts; k++) {
+					runs += j->iter[wire_idx][k];
+					if (j->icrit[wire_idx][k] > 0.0) {
+						answers->icurve[k][wire_idx] += j->icrit[wire_idx][k];
+						++found[k][wire_idx];
+						if (op) fprintf (op, " %8.3f", 0.001 * j->icrit[wire_idx][k]);
+					} else {
+						++failed;
+						if (logfp) fprintf (logfp, "no critical current for pole %d, wire %d, tf = %G us\n",
+							pole_number, wire_idx + 1, 1.0e6 * j->ftf[k]);
+						if (op) fprintf (op, " %8s", "-");
+					}
+				}
+				if (op) fprintf (op, "\n");
+			}
+		}
+	}
+	if (j->workers > 1) {
+		stop_workers ();
+	}
+/* average each point over the poles where its search succeeded */
+	for (k = 0; k < j->fronts; k++) {
+		for (wire_idx = 0; wire_idx < MAX_WIRES_HIT; wire_idx++) {
+			if (found[k][wire_idx] > 0) {
+				answers->icurve[k][wire_idx] /= found[k][wire_idx];
+			}
+		}
+	}
+	if (logfp) {
+		fprintf (logfp, "critical current curves took %d iterations\n", runs);
+		if (failed > 0) {
+			fprintf (logfp, "%d curve points failed and were left out of the averages\n", failed);
+		}
+	}
+}
+
+/* get a valid solution for this step, solving again until no arrester or
+pipegap changes state */
+
+void solve_time_step (void)
+{
+	solution_valid = FALSE;
+	while (!solution_valid) {
+		do_all_poles (zero_pole_injection);
+		do_all_surges (inject_surge);
+		do_all_steepfronts (inject_steepfront);
+		do_all_sources (inject_source);
+		do_all_grounds (inject_ground);
+		if (using_multiple_span_defns) {
+			do_all_lines (inject_line_iphase);
+		} else {
+			do_all_lines (inject_line_imode);
+			do_all_poles (inject_pole_imode);
+		}
+		do_all_arresters (inject_arrester);
+		do_all_pipegaps (inject_pipegap);
+		do_all_inductors (inject_inductor_history);
+		do_all_capacitors (inject_capacitor_history);
+		do_all_poles (triang_pole);
+		do_all_poles (solve_pole);
+		solution_valid = TRUE; /* see if an arrester changed state - need to resolve */
+		do_all_arresters (check_arrester);
+		do_all_pipegaps (check_pipegap);
+	}
+}
+
+/* the energy-storage and arrester history terms for the next step */
+
+void update_lumped_history (void)
+{
+	do_all_inductors (update_inductor_history);
+	do_all_arresters (update_arrester_history);
+	do_all_arrbezs (update_arrbez_history);
+	do_all_capacitors (update_capacitor_history);
+	do_all_customers (update_customer_history);
+}
+
+/* run a complete simulation, assuming the initial conditions have been
+set properly */
+
+void time_step_loops (LPLTOUTSTRUCT answers, double precision)
+{
+	si_precision = precision;
+	t = 0.0;
+	step = 0;
+	flash_halt = FALSE;
+	if (want_sensitivity) {
+		reset_sensitivity ();
+	}
+	if (op) {
+//		printf ("%le <- Tmax\n", Tmax);
+//		printf ("%le <- Time Now\r", t);
+	}
+	if (bp) {  /* initialize plot file */
+		InitializePlotOutput (meter_head, dT, Tmax);
+	}
+	do_all_monitors (find_monitor_links);
+	do { /* keep going till we hit Tmax, or an insulator flashes over when flash_halt_enabled */
+		if (substep_switching) {
+			save_step_state ();
+		}
+		solve_time_step ();
+		if (want_sensitivity) {
+			sensitivity_step ();
+		}
+/* update the non-linear and energy-storage history terms for the next step */
+		do_all_grounds (check_ground);
+		check_all_insulators ();  /* may set flash_halt */
+		do_all_lpms (check_lpm);
+		update_lumped_history ();
+		if (using_multiple_span_defns) {
+			do_all_lines (update_vmode_and_history);
+		} else {
+			do_all_poles (calc_pole_vmode);
+			do_all_lines (update_line_history);
+		}
+		if (substep_switching) {
+			resync_switching ();
+		}
+		if (bp) {  
+			WritePlotTimeStep (meter_head, t);
+		} else {
+			do_all_meters (update_meter_peaks);
+		}
+		do_all_monitors (update_monitor_pts);
+#ifdef LOG_POLES_AND_LINES
+		do_all_poles (print_pole_data);
+		do_all_lines (print_line_history);
+#endif
+		if (op) {  /* progress report */
+			if (step % 10 == 0) {
+//				printf ("%le\r", t);
+			}
+		}
+		if (using_second_dT && !dT_switched) {
+			if (t >= dT_switch_time) {
+				change_time_step();
+			}
+		}
+		t += dT;  /* advance the time step */
+		++step;
+	} while (t <= Tmax && !flash_halt);
+	if (logfp) fprintf( logfp, "\n");
+/* set up "quick answers" for DOS version */
+	SI = energy = charge = current = predischarge = 0.0;
+	do_all_arresters (arrester_answers_cleanup);
+	do_all_pipegaps (pipegap_answers_cleanup);
+	do_all_insulators (insulator_answers_cleanup);
+	do_all_lpms (lpm_answers_cleanup);
+	do_all_arrbezs (arrbez_answers_cleanup);
+	answers->SI = SI; /* severity index for insulator closest to flashing over */
+	answers->energy = energy;  /* highest arrester discharge parameters */
+	answers->charge = charge;
+	answers->current = current;
+	answers->predischarge = predischarge;
+	if (want_sensitivity) {
+		sensitivity_answers (answers);
+	}
+	do_all_monitors (update_monitor_summary);
+	if (bp) {
+		FinalizePlotHeader (t);
+	}
+}
+
@@ -1,166 +1,210 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-#ifndef oetypes_included
-#define oetypes_included
-
-#ifndef TRUE
-#define TRUE 1
-#endif
-
-#ifndef FALSE
-#define FALSE 0
-#endif
-
-/*    defined error codes for oe_exit.  */
-
-#define	ERR_OVERLAP		     1
-#define	ERR_MALLOC 		     2
-#define	ERR_BUFFER_MISSING   3
-#define	ERR_LVDC		     4
-#define	ERR_PHASE_READ  	 5
-#define	ERR_NPHASES		     6
-#define	ERR_NPOLES 		     7
-#define	ERR_CABLE_PHASES	 8
-#define	ERR_CONDUCTOR_N 	 9
-#define	ERR_MISSING_CONDUCTOR   10
-#define	ERR_RADIUS 		    11
-#define	ERR_HEIGHT 		    12
-#define	ERR_UNMATCHED_PAIR  13
-#define	ERR_BAD_PAIR    	14
-#define	ERR_BAD_POLE    	15
-#define	ERR_LT_STOPPED  	16
-#define	ERR_ARRTAU_STOPPED  17
-#define	ERR_MATH_ALLOC  	18
-#define	ERR_MATH_CALC   	19
-#define	ERR_OUT_OF_RANGE   	20
-#define ERR_BAD_ARR_VI      21
-#define ERR_MIXED_LINES     22
-
-void oe_exit (int i);
-
-extern FILE *logfp;
-
-#define ONE_SHOT		0  /* ltengine iteration modes */
-#define FIND_CRITICAL_CURRENT	1
-
-#define INVALID_PHASE -1
-#define MAX_CIRCUITS 3
-#define MAX_PHASES 3   /* Phases per circuit */
-#define MAX_GNDS 2     /* Grounds per circuit */
-#define MAX_GND_WIRES 6
-#define MAX_PHS_WIRES 9
-#define MAX_WIRES_HIT 15  /* MAX_PHS_WIRES+MAX_GND_WIRES */
-#define MAX_POLE_NODES 16 /* MAX_WIRES_HIT + 1 */
-#define MAX_CFOS 45       /* MAX_PHS_WIRES*(MAX_PHSWIRES+1)/2 */
-
-#define MAX_REPORT        3 /*array index values defined below */
-#define SINGLE_CONDUCTOR  0 /*flashovers on just one conductor in this circuit */
-#define MULTI_CONDUCTOR   1 /*flashovers on two or three conductors in this circuit */
-#define MULTI_CIRCUIT     2 /*flashover on at least one conductor in this circuit and at least one other circuit on the same pole */
-
-#define TWOPI         6.2831853
-#define EPSILON       0.00001     /* tolerance */
-#define V_MIN         1.0e-3
-#define Y_SHORT       1.0e3       /* admittance for a "short circuit" */
-#define LIGHT         3.0e8       /* speed of light in m/sec */
-#define I_GROUND_MIN  100.0       /* minimum current for impulse ground modeling */
-#define PRIM_L        2.0e-7  /* primitive inductance coefficient, H/m */
-#define DEFAULT_LEAD_R	0.00635  /* ground/arrester lead radius, m */
-#define CFKONST       2.815863   /* constants for 1 - cosine wave front */
-#define CTKONST       4.0
-#define ETKONST       1.442695  /* time constant = ETKONST * tail time */
-#define TOKEN_LENGTH	256
-#define BUFFER_LENGTH	10000  /* buffer size for transient simulation input */
-#define BUFFER_LENGTH_LESS_1	9999
-#define LOW_START	0    /* histogram bin numbers for starting critical current iterations */
-#define BACKFLASH_START	10
-#define ARRESTER_START	19
-
-#define THREE 3
-
-enum plot_type {
-	PLT_NONE,
-	PLT_CSV,
-	PLT_TAB,
-	PLT_ELT,
-	PLT_MAT }; // MatLab not implemented yet
-
-typedef struct tagLTINSTRUCT {
-	double ic;  /* critical current to cause flashover */
-	FILE *fp;   /* input file */
-	FILE *op;   /* text output file, for DOS only */
-	FILE *bp;   /* plot output file */
-	int plot_type;
-	int stop_on_flashover;
-	int iteration_mode;  /* none, critical current, transformer case */
-	int first_pole_hit;  /* indicates which poles and wires to find critical current for */
-	int last_pole_hit;
-	int wire_struck [MAX_WIRES_HIT];  /* >0 if wire is exposed to direct stroke */
-} LTINSTRUCT;
-
-typedef LTINSTRUCT *LPLTINSTRUCT;
-
-typedef struct tagLTOUTSTRUCT {
-	double SI;      /* highest insulator severity index */
-	double energy;  /* highest arrester discharge energy */
-	double current;  /* highest arrester discharge current */
-	double charge;   /* highest arrester charge */
-	double predischarge;  /* highest predischarge current */
-	double icritical [MAX_WIRES_HIT]; /* critical current for direct stroke to each wire */
-} LTOUTSTRUCT;
-
-typedef LTOUTSTRUCT *LPLTOUTSTRUCT;
-
-extern long nr_iter;
-extern int nr_max;
-
-extern FILE *op; /* text output file */
-extern FILE *bp; /* plot file */
-
-extern int plot_type;
-
-/* global simulation parameters */
-
-extern int using_network;  /* used time, span, and line tokens */
-extern int using_multiple_span_defns;  /* can't just work with span_head */
-extern int number_of_nodes;  /* number of nodes at each pole */
-extern int number_of_conductors;  /* number of conductors at each pole (<= number_of_nodes) */
-extern int number_of_poles; /* number of poles in circuit */
-extern double span_length; /* pole span in meters */
-extern double dT;  /* simulation time step, seconds */
-extern double t;  /* current simulation time, advances by dT */
-extern double Tmax;  /* simulation stop time, seconds */
-extern int step;  /* current simulation step number */
-extern int solution_valid; /* flag for solving arresters at each time step */
-extern int left_end_z; /* TRUE if left end of circuit has surge impedance terminations */
-extern int right_end_z;
-
-extern double predischarge;  /* maximum predischarge current in pipegaps */
-extern double SI, energy, current, charge; /* maximum insulator severity index, and
-	maximum arrester energy, current, and charge, of all components in the simulation */
-extern int flash_halt, flash_halt_enabled; /* flags to stop simulation if an insulator flashes over */
-extern int want_si_calculation;  /* set 1 for solution by bisection, 0 for an estimate */
-extern int gi_iteration_mode;
-
-/* transient simulation module */
-int lt (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers);
-
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef oetypes_included
+#define oetypes_included
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/*    defined error codes for oe_exit.  */
+
+#define	ERR_OVERLAP		     1
+#define	ERR_MALLOC 		     2
+#define	ERR_BUFFER_MISSING   3
+#define	ERR_LVDC		     4
+#define	ERR_PHASE_READ  	 5
+#define	ERR_NPHASES		     6
+#define	ERR_NPOLES 		     7
+#define	ERR_CABLE_PHASES	 8
+#define	ERR_CONDUCTOR_N 	 9
+#define	ERR_MISSING_CONDUCTOR   10
+#define	ERR_RADIUS 		    11
+#define	ERR_HEIGHT 		    12
+#define	ERR_UNMATCHED_PAIR  13
+#define	ERR_BAD_PAIR    	14
+#define	ERR_BAD_POLE    	15
+#define	ERR_LT_STOPPED  	16
+#define	ERR_ARRTAU_STOPPED  17
+#define	ERR_MATH_ALLOC  	18
+#define	ERR_MATH_CALC   	19
+#define	ERR_OUT_OF_RANGE   	20
+#define ERR_BAD_ARR_VI      21
+#define ERR_MIXED_LINES     22
+#define ERR_DECK_STRUCTURE  23
+
+void oe_exit (int i);
+
+extern FILE *logfp;
+
+#define ONE_SHOT		0  /* ltengine iteration modes */
+#define FIND_CRITICAL_CURRENT	1
+#define MONTE_CARLO		2
+
+#define INVALID_PHASE -1
+#define MAX_CIRCUITS 3
+#define MAX_PHASES 3   /* Phases per circuit */
+#define MAX_GNDS 2     /* Grounds per circuit */
+#define MAX_GND_WIRES 6
+#define MAX_PHS_WIRES 9
+#define MAX_WIRES_HIT 15  /* MAX_PHS_WIRES+MAX_GND_WIRES */
+#define MAX_POLE_NODES 16 /* MAX_WIRES_HIT + 1 */
+#define MAX_CFOS 45       /* MAX_PHS_WIRES*(MAX_PHSWIRES+1)/2 */
+#define MAX_FRONTS 32     /* front times on a critical current curve */
+
+#define MAX_REPORT        3 /*array index values defined below */
+#define SINGLE_CONDUCTOR  0 /*flashovers on just one conductor in this circuit */
+#define MULTI_CONDUCTOR   1 /*flashovers on two or three conductors in this circuit */
+#define MULTI_CIRCUIT     2 /*flashover on at least one conductor in this circuit and at least one other circuit on the same pole */
+
+#define TWOPI         6.2831853
+#define EPSILON       0.00001     /* tolerance */
+#define V_MIN         1.0e-3
+#define Y_SHORT       1.0e3       /* admittance for a "short circuit" */
+#define LIGHT         3.0e8       /* speed of light in m/sec */
+#define I_GROUND_MIN  100.0       /* minimum current for impulse ground modeling */
+#define PRIM_L        2.0e-7  /* primitive inductance coefficient, H/m */
+#define DEFAULT_LEAD_R	0.00635  /* ground/arrester lead radius, m */
+#define CFKONST       2.815863   /* constants for 1 - cosine wave front */
+#define CTKONST       4.0
+#define ETKONST       1.442695  /* time constant = ETKONST * tail time */
+#define TOKEN_LENGTH	256
+#define BUFFER_LENGTH	10000  /* first buffer size for transient simulation input, doubled as needed */
+#define LOW_START	0    /* histogram bin numbers for starting critical current iterations */
+#define BACKFLASH_START	10
+#define ARRESTER_START	19
+
+#define THREE 3
+
+enum plot_type {
+	PLT_NONE,
+	PLT_CSV,
+	PLT_TAB,
+	PLT_ELT,
+	PLT_BIN,    // chunked columnar binary, double samples
+	PLT_BIN32,  // the same with float samples
+	PLT_BINZ,   // the same with WaveCodec samples
+	PLT_MAT }; // MatLab not implemented yet
+
+enum decimation {
+	DECIMATE_NONE,
+	DECIMATE_STEP,  // one plot row per output interval
+	DECIMATE_PEAK,  // lowest and highest of each meter per output interval
+	DECIMATE_ADAPT }; // rows where a meter moved past a tolerance
+
+typedef struct tagLTINSTRUCT {
+	double ic;  /* critical current to cause flashover */
+	FILE *fp;   /* input file */
+	FILE *op;   /* text output file, for DOS only */
+	FILE *bp;   /* plot output file */
+	int plot_type;
+	int stop_on_flashover;
+	int iteration_mode;  /* none, critical current, transformer case */
+	int first_pole_hit;  /* indicates which poles and wires to find critical current for */
+	int last_pole_hit;
+	int wire_struck [MAX_WIRES_HIT];  /* >0 if wire is exposed to direct stroke */
+	int use_window;  /* TRUE to simulate only the poles each stroke can reach */
+	int use_newton;  /* TRUE to iterate for critical current using dSI/dI */
+	int lanes;  /* number of critical current cases to simulate in lockstep */
+	int samples;  /* Monte Carlo strokes to simulate */
+	unsigned long seed;  /* Monte Carlo random number seed */
+	int workers;  /* Monte Carlo worker processes, 0 for one per processor */
+	double rel_error;  /* stop Monte Carlo when the flashover probability is this close, 0 to run all samples */
+	int subsequent;  /* TRUE to sample subsequent instead of first strokes */
+	double i_shift;  /* importance sampling shift of the log current, in standard deviations */
+	double t_shift;  /* importance sampling shift of the log front time, down, in standard deviations */
+	int latin_hypercube;  /* TRUE to stratify the Monte Carlo samples */
+	int fronts;  /* number of front times for critical current curves, 0 for one critical current */
+	double front_min;  /* range of the front times, in us */
+	double front_max;
+} LTINSTRUCT;
+
+typedef LTINSTRUCT *LPLTINSTRUCT;
+
+typedef struct tagLTOUTSTRUCT {
+	double SI;      /* highest insulator severity index */
+	double energy;  /* highest arrester discharge energy */
+	double current;  /* highest arrester discharge current */
+	double charge;   /* highest arrester charge */
+	double predischarge;  /* highest predischarge current */
+	double dSI;  /* derivative of SI with respect to the stroke peak, if calculated */
+	double icritical [MAX_WIRES_HIT]; /* critical current for direct stroke to each wire */
+	int samples;       /* Monte Carlo strokes simulated */
+	double p_flash;    /* Monte Carlo flashover probability */
+	double p_flash_ci; /* half-width of its 95% confidence interval */
+	int fronts;        /* critical current curves */
+	double front [MAX_FRONTS];
+	double icurve [MAX_FRONTS][MAX_WIRES_HIT];
+} LTOUTSTRUCT;
+
+typedef LTOUTSTRUCT *LPLTOUTSTRUCT;
+
+extern long nr_iter;
+extern int nr_max;
+extern int nr_chord;  /* TRUE to reuse the arrester jacobian factors while Newton converges */
+extern int implicit_grounds;  /* TRUE to solve ground ionization with the arresters in solve_pole */
+extern int substep_switching;  /* TRUE to switch at the crossing within the time step, not on the grid */
+extern int plot_precision;  /* digits after the point in text plot files */
+extern int plot_decimation;  /* one of enum decimation */
+extern double plot_decimation_value;  /* output interval in seconds, or per-unit tolerance */
+extern int plot_capture;  /* TRUE to plot only around flashovers, sparkovers and threshold crossings */
+extern double plot_capture_pre;  /* seconds plotted before a trigger */
+extern double plot_capture_post;  /* seconds plotted after a trigger */
+extern double plot_threshold;  /* meter volts that trigger a capture, or 0 */
+extern double wave_quantum;  /* volts kept by the waveform codec, twice its error bound */
+
+extern FILE *op; /* text output file */
+extern FILE *bp; /* plot file */
+
+extern int plot_type;
+
+/* global simulation parameters */
+
+extern int using_network;  /* used time, span, and line tokens */
+extern int using_multiple_span_defns;  /* can't just work with span_head */
+extern int number_of_nodes;  /* number of nodes at each pole */
+extern int number_of_conductors;  /* number of conductors at each pole (<= number_of_nodes) */
+extern int number_of_poles; /* number of poles in circuit */
+extern double span_length; /* pole span in meters */
+extern double dT;  /* simulation time step, seconds */
+extern double t;  /* current simulation time, advances by dT */
+extern double Tmax;  /* simulation stop time, seconds */
+extern int step;  /* current simulation step number */
+extern int solution_valid; /* flag for solving arresters at each time step */
+extern int left_end_z; /* TRUE if left end of circuit has surge impedance terminations */
+extern int right_end_z;
+
+extern double predischarge;  /* maximum predischarge current in pipegaps */
+extern double SI, energy, current, charge; /* maximum insulator severity index, and
+	maximum arrester energy, current, and charge, of all components in the simulation */
+extern int flash_halt, flash_halt_enabled; /* flags to stop simulation if an insulator flashes over */
+extern int want_si_calculation;  /* set 1 for solution by bisection, 0 for an estimate */
+extern double si_precision;  /* LPM SI accuracy that time_step_loops was asked for, 0 for full */
+extern int gi_iteration_mode;
+
+/* transient simulation module */
+int lt (LPLTINSTRUCT lt_input, LPLTOUTSTRUCT answers);
+
 #endif
\ No newline at end of file
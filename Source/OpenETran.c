@@ -1,221 +1,367 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-
-#include "OETypes.h"
-
-#ifdef linux
-#define strnicmp strncasecmp
-#endif
-
-#define STREAM_LEN 4096
-#define INPUT_EXT      ".dat"
-#define OUTPUT_EXT     ".out"
-#define MAXPATHLEN   256
-
-FILE *logfp = NULL;
-long nr_iter = 0L;
-int nr_max = 0;
-FILE *op = NULL;
-FILE *bp = NULL;
-int plot_type = PLT_NONE;
-
-void usage ()
-{
-	printf ("usage (one-shot): openetran -plot [none|csv|tab|elt] filename.dat\n");
-	printf ("usage (iteration): openetran -icrit first_pole last_pole wire_flags ... filename.dat\n");
-	exit (EXIT_FAILURE);
-}
-
-int main (int argc, char *argv[])
-{
-	LPLTINSTRUCT  lp_in;
-	LPLTOUTSTRUCT lp_out;
-	FILE *fp;
-	char basename [MAXPATHLEN];
-	char inputname [MAXPATHLEN];
-	char outputname [MAXPATHLEN];
-	char plotname [MAXPATHLEN];
-	char buf [MAXPATHLEN];
-	char *pc;
-	int iteration_mode = ONE_SHOT;
-	int stop_on_flashover = FALSE;
-	int idx;
-
-	logfp = fopen ("openetran.log", "w");
-	if (argc >= 4) {
-		strcpy (buf, argv[1]);
-		if (strnicmp (buf, "-p", 2) == 0) { // single-shot run with plots
-			strcpy (buf, argv[2]);
-			switch (tolower (buf[0])) {
-				case 'c': plot_type = PLT_CSV; break;
-				case 't': plot_type = PLT_TAB; break;
-				case 'e': plot_type = PLT_ELT; break;
-				default: plot_type = PLT_NONE; break;
-			}
-		} else if (strnicmp (buf, "-i", 2) == 0) { // critical current iterations
-			iteration_mode = FIND_CRITICAL_CURRENT;
-			stop_on_flashover = TRUE;
-		} else {
-			usage ();
-		}
-		(void) strcpy (buf, argv[argc - 1]); // last argument is the file name
-		pc = strrchr (buf, '.');
-		if (pc) {
-			*pc = '\0';
-		}
-		strcpy (basename, buf);
-	} else {
-		usage ();
-	}
-
-	(void) strcpy (inputname, basename);
-	(void) strcpy (outputname, basename);
-	(void) strcpy (plotname, basename);
-
-	(void) strcat (inputname, INPUT_EXT);
-	(void) strcat (outputname, OUTPUT_EXT);
-	switch (plot_type) {
-		case PLT_CSV: (void) strcat (plotname, ".csv"); break;
-		case PLT_TAB: (void) strcat (plotname, ".txt"); break;
-		case PLT_ELT: (void) strcat (plotname, ".elt"); break;
-		case PLT_MAT: plotname[0] = '\0'; break;
-		case PLT_NONE: plotname[0] = '\0'; break;
-		default: break;
-	}
-
-	if (!(fp = fopen (inputname, "r"))) {
-		printf ("failed to open input file %s\n", inputname);
-		exit (EXIT_FAILURE);
-	}
-	if (!(op = fopen (outputname, "w"))) {
-		printf ("failed to open output file %s\n", outputname);
-		exit (EXIT_FAILURE);
-	}
-	if (plotname[0] != '\0') {
-		if (!(bp = fopen (plotname, "wb"))) {
-			printf ("failed to open plot file %s\n", plotname);
-			exit (EXIT_FAILURE);
-		}
-	}
-	if ((lp_in = (LPLTINSTRUCT) malloc (sizeof *lp_in))) {
-		lp_in->stop_on_flashover = stop_on_flashover;
-		lp_in->iteration_mode = iteration_mode;
-		lp_in->fp = fp;
-		lp_in->bp = bp;
-		lp_in->op = op;
-	} else {
-		printf ("failed to allocate input struct storage\n");
-		exit (EXIT_FAILURE);
-	}
-	if (iteration_mode == FIND_CRITICAL_CURRENT) {
-		lp_in->first_pole_hit = atoi (argv[2]);
-		lp_in->last_pole_hit = atoi (argv[3]);
-		for (idx = 0; idx < MAX_WIRES_HIT; ++idx) {
-			lp_in->wire_struck[idx] = 0;
-		}
-		for (idx = 4; idx < argc - 1; ++idx) {
-			lp_in->wire_struck[idx - 4] = atoi (argv[idx]);
-		}
-	}
-	
-	if ((lp_out = (LPLTOUTSTRUCT) malloc (sizeof *lp_out))) {
-		lt (lp_in, lp_out);
-	} else {
-		printf ("failed to allocate output storage\n");
-		exit (EXIT_FAILURE);
-	}
-
-	if (iteration_mode == ONE_SHOT) {
-		printf ("\nOutput Values:\n");
-		printf ("  SI:      %4e\n", lp_out->SI);
-		printf ("  Energy:  %4e\n", lp_out->energy);
-		printf (" current: %4e\n", lp_out->current);
-		printf (" charge:  %4e\n", lp_out->charge);
-		printf (" pipegap:  %4e\n", lp_out->predischarge);
-	} else if (iteration_mode == FIND_CRITICAL_CURRENT) {
-		printf ("\nAverage Critical Currents, Poles %d to %d\n", lp_in->first_pole_hit, lp_in->last_pole_hit);
-		for (idx = 0; idx < MAX_WIRES_HIT; ++idx) {
-			if (lp_in->wire_struck[idx] > 0) {
-				printf (" wire %2d: %4e\n", idx+1, lp_out->icritical[idx]); 
-			}
-		}
-	}
-
-	if (fp) {
-		fclose (fp);
-	}
-	if (bp) {
-		fclose (bp);
-	}
-	if (op && (op != stdout)) {
-		fclose (op);
-	}
-	if (logfp) {
-		fclose (logfp);
-	}
-	free (lp_in);
-	free (lp_out);
-	return 0;
-}
-
-static char *err_msg[] = {
-	"No error",  // 0
-	"Overlapping conductors", //	ERR_OVERLAP		1
-	"Can't allocate memory", //	ERR_MALLOC 		2
-	"No input available for lt simulation", //	ERR_BUFFER_MISSING      3
-	"Initial DC voltage on inductor", //	ERR_LVDC		4
-	"Can't read number of phases", //	ERR_PHASE_READ  	5
-	"Bad number of phases", //	ERR_NPHASES		6
-	"Bad number of poles", //	ERR_NPOLES 		7
-	"Too many conductors", //	ERR_CABLE_PHASES	8
-	"Bad conductor number", //	ERR_CONDUCTOR_N 	9
-	"Missing a conductor", //	ERR_MISSING_CONDUCTOR   10
-	"Bad conductor radius", //	ERR_RADIUS 		11
-	"Bad conductor height", //	ERR_HEIGHT 		12
-	"Unmatched pair input", //	ERR_UNMATCHED_PAIR      13
-	"Bad pair number on component", //	ERR_BAD_PAIR    	14
-	"Bad pole number on component", //	ERR_BAD_POLE    	15
-	"Transient simulation stopped (convergence failure)", //	ERR_LT_STOPPED  	16
-	"Arrester energy calculation stopped (convergence failure)", //	ERR_ARRTAU_STOPPED      17
-	"Can't allocate memory in math library", //	ERR_MATH_ALLOC  	18
-	"Calculation error in math library", //	ERR_MATH_CALC   	19
-	"Subscript out of range", //	ERR_OUT_OF_RANGE   	20
-	"No arrester discharge voltage defined", // ERR_BAD_ARR_VI      21
-	"Mixed conductor and cable input for same span" // ERR_MIXED_LINES 22
-};
-
-void oe_exit (int i)
-{
-	if (logfp) {
-		fclose(logfp);
-		logfp = NULL;
-	}
-	if (i) {
-/*		MessageBox (NULL, err_msg[i], "OpenETran Error", MB_ICONEXCLAMATION); */
-        fprintf (stderr, "OpenEtran Error: %s\n", err_msg[i]);
-	}
-	exit (i);
+﻿/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012, 
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "OETypes.h"
+
+#ifdef linux
+#define strnicmp strncasecmp
+#endif
+
+#define STREAM_LEN 4096
+#define INPUT_EXT      ".dat"
+#define OUTPUT_EXT     ".out"
+#define MAXPATHLEN   256
+
+FILE *logfp = NULL;
+long nr_iter = 0L;
+int nr_max = 0;
+int nr_chord = FALSE;
+int implicit_grounds = FALSE;
+int substep_switching = FALSE;
+int plot_precision = 6;
+int plot_decimation = DECIMATE_NONE;
+double plot_decimation_value = 0.0;
+int plot_capture = FALSE;
+double plot_capture_pre = 0.0;
+double plot_capture_post = 0.0;
+double plot_threshold = 0.0;
+double wave_quantum = 0.1;
+FILE *op = NULL;
+FILE *bp = NULL;
+int plot_type = PLT_NONE;
+
+void usage ()
+{
+	printf ("usage (one-shot): openetran -plot [none|csv|tab|elt|bin|float|zip] filename.dat\n");
+	printf ("usage (iteration): openetran -icrit first_pole last_pole wire_flags ... filename.dat\n");
+	printf ("usage (Monte Carlo): openetran -montecarlo first_pole last_pole wire_flags ... filename.dat\n");
+	printf ("options: -window  simulate only the poles each stroke can reach before Tmax\n");
+	printf ("         -newton  iterate for critical current with Newton steps, using dSI/dI\n");
+	printf ("         -chord  keep the arrester Newton jacobian while it converges\n");
+	printf ("         -implicit  solve ground ionization within each time step\n");
+	printf ("         -substep  switch sparkovers and flashovers at their interpolated instants within the step\n");
+	printf ("         -precision N  digits after the point in csv and tab plots (default 6)\n");
+	printf ("         -decimate step DT  plot one row every DT seconds\n");
+	printf ("         -decimate peak DT  plot the lowest and highest values in each DT seconds\n");
+	printf ("         -decimate adapt E  plot when a meter moves more than E per unit of its peak\n");
+	printf ("         -capture PRE POST  plot only from PRE seconds before to POST seconds after\n");
+	printf ("             each flashover or arrester sparkover\n");
+	printf ("         -threshold V  with -capture, also trigger when a voltage meter exceeds V\n");
+	printf ("         -quantum Q  volts resolved by the compressed waveforms (default 0.1)\n");
+	printf ("         -lanes K  bracket the critical current with K cases in lockstep (2 to 8)\n");
+	printf ("         -samples N  Monte Carlo strokes to simulate (default 1000)\n");
+	printf ("         -seed S  Monte Carlo random number seed (default 1)\n");
+	printf ("         -workers W  Monte Carlo worker processes (default one per processor)\n");
+	printf ("         -relerr E  stop when the flashover probability is within E, per unit\n");
+	printf ("         -subsequent  sample subsequent instead of first strokes\n");
+	printf ("         -ishift B  sample currents B standard deviations higher, with weights\n");
+	printf ("         -tshift B  sample fronts B standard deviations shorter, with weights\n");
+	printf ("         -lhs  stratify the samples with Latin hypercubes\n");
+	printf ("         -fronts N tf1 tf2  critical current curves at N front times from tf1 to tf2 us\n");
+	exit (EXIT_FAILURE);
+}
+
+int main (int argc, char *argv[])
+{
+	LPLTINSTRUCT  lp_in;
+	LPLTOUTSTRUCT lp_out;
+	FILE *fp;
+	char basename [MAXPATHLEN];
+	char inputname [MAXPATHLEN];
+	char outputname [MAXPATHLEN];
+	char plotname [MAXPATHLEN];
+	char buf [MAXPATHLEN];
+	char *pc;
+	int iteration_mode = ONE_SHOT;
+	int stop_on_flashover = FALSE;
+	int use_window = FALSE;
+	int use_newton = FALSE;
+	int lanes = 1;
+	int samples = 1000;
+	unsigned long seed = 1;
+	int workers = 0;
+	double rel_error = 0.0;
+	int subsequent = FALSE;
+	double i_shift = 0.0;
+	double t_shift = 0.0;
+	int latin_hypercube = FALSE;
+	int fronts = 0;
+	double front_min = 0.0, front_max = 0.0;
+	int idx, nargs, k;
+
+	logfp = fopen ("openetran.log", "w");
+/* take out the optional switches, so the other arguments keep their places */
+	for (idx = 1, nargs = 1; idx < argc; ++idx) {
+		if (strnicmp (argv[idx], "-window", 7) == 0) {
+			use_window = TRUE;
+		} else if (strnicmp (argv[idx], "-newton", 7) == 0) {
+			use_newton = TRUE;
+		} else if (strnicmp (argv[idx], "-chord", 6) == 0) {
+			nr_chord = TRUE;
+		} else if (strnicmp (argv[idx], "-implicit", 9) == 0) {
+			implicit_grounds = TRUE;
+		} else if (strnicmp (argv[idx], "-substep", 8) == 0) {
+			substep_switching = TRUE;
+		} else if (strnicmp (argv[idx], "-precision", 10) == 0 && idx + 1 < argc) {
+			plot_precision = atoi (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-decimate", 9) == 0 && idx + 2 < argc) {
+			switch (tolower (argv[++idx][0])) {
+				case 's': plot_decimation = DECIMATE_STEP; break;
+				case 'p': plot_decimation = DECIMATE_PEAK; break;
+				case 'a': plot_decimation = DECIMATE_ADAPT; break;
+				default: usage (); break;
+			}
+			plot_decimation_value = atof (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-capture", 8) == 0 && idx + 2 < argc) {
+			plot_capture = TRUE;
+			plot_capture_pre = atof (argv[++idx]);
+			plot_capture_post = atof (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-threshold", 10) == 0 && idx + 1 < argc) {
+			plot_threshold = atof (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-quantum", 8) == 0 && idx + 1 < argc) {
+			wave_quantum = atof (argv[++idx]);
+			if (wave_quantum <= 0.0) usage ();
+		} else if (strnicmp (argv[idx], "-lanes", 6) == 0 && idx + 1 < argc) {
+			lanes = atoi (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-samples", 8) == 0 && idx + 1 < argc) {
+			samples = atoi (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-seed", 5) == 0 && idx + 1 < argc) {
+			seed = strtoul (argv[++idx], NULL, 10);
+		} else if (strnicmp (argv[idx], "-workers", 8) == 0 && idx + 1 < argc) {
+			workers = atoi (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-relerr", 7) == 0 && idx + 1 < argc) {
+			rel_error = atof (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-subsequent", 11) == 0) {
+			subsequent = TRUE;
+		} else if (strnicmp (argv[idx], "-ishift", 7) == 0 && idx + 1 < argc) {
+			i_shift = atof (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-tshift", 7) == 0 && idx + 1 < argc) {
+			t_shift = atof (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-fronts", 7) == 0 && idx + 3 < argc) {
+			fronts = atoi (argv[++idx]);
+			front_min = atof (argv[++idx]);
+			front_max = atof (argv[++idx]);
+		} else if (strnicmp (argv[idx], "-lhs", 4) == 0) {
+			latin_hypercube = TRUE;
+		} else {
+			argv[nargs++] = argv[idx];
+		}
+	}
+	argc = nargs;
+	if (argc >= 4) {
+		strcpy (buf, argv[1]);
+		if (strnicmp (buf, "-p", 2) == 0) { // single-shot run with plots
+			strcpy (buf, argv[2]);
+			switch (tolower (buf[0])) {
+				case 'c': plot_type = PLT_CSV; break;
+				case 't': plot_type = PLT_TAB; break;
+				case 'e': plot_type = PLT_ELT; break;
+				case 'b': plot_type = PLT_BIN; break;
+				case 'f': plot_type = PLT_BIN32; break;
+				case 'z': plot_type = PLT_BINZ; break;
+				default: plot_type = PLT_NONE; break;
+			}
+		} else if (strnicmp (buf, "-i", 2) == 0) { // critical current iterations
+			iteration_mode = FIND_CRITICAL_CURRENT;
+			stop_on_flashover = TRUE;
+		} else if (strnicmp (buf, "-m", 2) == 0) { // Monte Carlo strokes
+			iteration_mode = MONTE_CARLO;
+			stop_on_flashover = TRUE;
+		} else {
+			usage ();
+		}
+		(void) strcpy (buf, argv[argc - 1]); // last argument is the file name
+		pc = strrchr (buf, '.');
+		if (pc) {
+			*pc = '\0';
+		}
+		strcpy (basename, buf);
+	} else {
+		usage ();
+	}
+
+	(void) strcpy (inputname, basename);
+	(void) strcpy (outputname, basename);
+	(void) strcpy (plotname, basename);
+
+	(void) strcat (inputname, INPUT_EXT);
+	(void) strcat (outputname, OUTPUT_EXT);
+	switch (plot_type) {
+		case PLT_CSV: (void) strcat (plotname, ".csv"); break;
+		case PLT_TAB: (void) strcat (plotname, ".txt"); break;
+		case PLT_ELT: (void) strcat (plotname, ".elt"); break;
+		case PLT_BIN: (void) strcat (plotname, ".oeb"); break;
+		case PLT_BIN32: (void) strcat (plotname, ".oeb"); break;
+		case PLT_BINZ: (void) strcat (plotname, ".oeb"); break;
+		case PLT_MAT: plotname[0] = '\0'; break;
+		case PLT_NONE: plotname[0] = '\0'; break;
+		default: break;
+	}
+
+	if (!(fp = fopen (inputname, "r"))) {
+		printf ("failed to open input file %s\n", inputname);
+		exit (EXIT_FAILURE);
+	}
+	if (!(op = fopen (outputname, "w"))) {
+		printf ("failed to open output file %s\n", outputname);
+		exit (EXIT_FAILURE);
+	}
+	if (plotname[0] != '\0') {
+		if (!(bp = fopen (plotname, "wb"))) {
+			printf ("failed to open plot file %s\n", plotname);
+			exit (EXIT_FAILURE);
+		}
+	}
+	if ((lp_in = (LPLTINSTRUCT) malloc (sizeof *lp_in))) {
+		lp_in->stop_on_flashover = stop_on_flashover;
+		lp_in->iteration_mode = iteration_mode;
+		lp_in->use_window = use_window;
+		lp_in->use_newton = use_newton;
+		lp_in->lanes = lanes;
+		lp_in->samples = samples > 0 ? samples : 1;
+		lp_in->seed = seed;
+		lp_in->workers = workers;
+		lp_in->rel_error = rel_error;
+		lp_in->subsequent = subsequent;
+		lp_in->i_shift = i_shift;
+		lp_in->t_shift = t_shift;
+		lp_in->latin_hypercube = latin_hypercube;
+		lp_in->fronts = (fronts > 0 && front_min > 0.0 && front_max > 0.0) ? fronts : 0;
+		lp_in->front_min = front_min;
+		lp_in->front_max = front_max;
+		lp_in->fp = fp;
+		lp_in->bp = bp;
+		lp_in->op = op;
+	} else {
+		printf ("failed to allocate input struct storage\n");
+		exit (EXIT_FAILURE);
+	}
+	if (iteration_mode == FIND_CRITICAL_CURRENT || iteration_mode == MONTE_CARLO) {
+		lp_in->first_pole_hit = atoi (argv[2]);
+		lp_in->last_pole_hit = atoi (argv[3]);
+		for (idx = 0; idx < MAX_WIRES_HIT; ++idx) {
+			lp_in->wire_struck[idx] = 0;
+		}
+		for (idx = 4; idx < argc - 1; ++idx) {
+			lp_in->wire_struck[idx - 4] = atoi (argv[idx]);
+		}
+	}
+	
+	if ((lp_out = (LPLTOUTSTRUCT) malloc (sizeof *lp_out))) {
+		lt (lp_in, lp_out);
+	} else {
+		printf ("failed to allocate output storage\n");
+		exit (EXIT_FAILURE);
+	}
+
+	if (iteration_mode == ONE_SHOT) {
+		printf ("\nOutput Values:\n");
+		printf ("  SI:      %4e\n", lp_out->SI);
+		printf ("  Energy:  %4e\n", lp_out->energy);
+		printf (" current: %4e\n", lp_out->current);
+		printf (" charge:  %4e\n", lp_out->charge);
+		printf (" pipegap:  %4e\n", lp_out->predischarge);
+	} else if (iteration_mode == FIND_CRITICAL_CURRENT && lp_in->fronts > 0) {
+		printf ("\nAverage Critical Currents versus Front Time, Poles %d to %d\n", lp_in->first_pole_hit, lp_in->last_pole_hit);
+		for (k = 0; k < lp_out->fronts; ++k) {
+			printf (" tf %8.3f us:", 1.0e6 * lp_out->front[k]);
+			for (idx = 0; idx < MAX_WIRES_HIT; ++idx) {
+				if (lp_in->wire_struck[idx] > 0) {
+					printf (" %4e", lp_out->icurve[k][idx]);
+				}
+			}
+			printf ("\n");
+		}
+	} else if (iteration_mode == FIND_CRITICAL_CURRENT) {
+		printf ("\nAverage Critical Currents, Poles %d to %d\n", lp_in->first_pole_hit, lp_in->last_pole_hit);
+		for (idx = 0; idx < MAX_WIRES_HIT; ++idx) {
+			if (lp_in->wire_struck[idx] > 0) {
+				printf (" wire %2d: %4e\n", idx+1, lp_out->icritical[idx]); 
+			}
+		}
+	} else if (iteration_mode == MONTE_CARLO) {
+		printf ("\nMonte Carlo Flashover Probability, Poles %d to %d\n", lp_in->first_pole_hit, lp_in->last_pole_hit);
+		printf (" samples: %d\n", lp_out->samples);
+		printf (" P:       %4e +/- %4e\n", lp_out->p_flash, lp_out->p_flash_ci);
+		printf (" Energy:  %4e\n", lp_out->energy);
+	}
+
+	if (fp) {
+		fclose (fp);
+	}
+	if (bp) {
+		fclose (bp);
+	}
+	if (op && (op != stdout)) {
+		fclose (op);
+	}
+	if (logfp) {
+		fclose (logfp);
+	}
+	free (lp_in);
+	free (lp_out);
+	return 0;
+}
+
+static char *err_msg[] = {
+	"No error",  // 0
+	"Overlapping conductors", //	ERR_OVERLAP		1
+	"Can't allocate memory", //	ERR_MALLOC 		2
+	"No input available for lt simulation", //	ERR_BUFFER_MISSING      3
+	"Initial DC voltage on inductor", //	ERR_LVDC		4
+	"Can't read number of phases", //	ERR_PHASE_READ  	5
+	"Bad number of phases", //	ERR_NPHASES		6
+	"Bad number of poles", //	ERR_NPOLES 		7
+	"Too many conductors", //	ERR_CABLE_PHASES	8
+	"Bad conductor number", //	ERR_CONDUCTOR_N 	9
+	"Missing a conductor", //	ERR_MISSING_CONDUCTOR   10
+	"Bad conductor radius", //	ERR_RADIUS 		11
+	"Bad conductor height", //	ERR_HEIGHT 		12
+	"Unmatched pair input", //	ERR_UNMATCHED_PAIR      13
+	"Bad pair number on component", //	ERR_BAD_PAIR    	14
+	"Bad pole number on component", //	ERR_BAD_POLE    	15
+	"Transient simulation stopped (convergence failure)", //	ERR_LT_STOPPED  	16
+	"Arrester energy calculation stopped (convergence failure)", //	ERR_ARRTAU_STOPPED      17
+	"Can't allocate memory in math library", //	ERR_MATH_ALLOC  	18
+	"Calculation error in math library", //	ERR_MATH_CALC   	19
+	"Subscript out of range", //	ERR_OUT_OF_RANGE   	20
+	"No arrester discharge voltage defined", // ERR_BAD_ARR_VI      21
+	"Mixed conductor and cable input for same span", // ERR_MIXED_LINES 22
+	"Bad include or repeat in the input" // ERR_DECK_STRUCTURE 23
+};
+
+void oe_exit (int i)
+{
+	if (logfp) {
+		fclose(logfp);
+		logfp = NULL;
+	}
+	if (i) {
+/*		MessageBox (NULL, err_msg[i], "OpenETran Error", MB_ICONEXCLAMATION); */
+        fprintf (stderr, "OpenEtran Error: %s\n", err_msg[i]);
+	}
+	exit (i);
 }
\ No newline at end of file
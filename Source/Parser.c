@@ -1,175 +1,529 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-/* this module is used to parse transient simulation input from a char
-buffer in memory */
-
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-#include "Parser.h"
-
-static char seps[] = " \t\n\v\f\r\a\b";  /* for the library function strtok */
-static char eat_line_seps[] = "\n\r";  /* for the library function strtok */
-
-static char *t;  /* points to a retrieved token */
-static char *ps;  /* points to current char location in the buffer sn */
-static char ns [64];  /* maximum size of a single token */
-
-/*  &&&&  input file parsing functions  */
-
-void init_parser (char *sn)
-{
-	ps = sn;
-	while (*ps != '\0' && isspace (*ps)) {
-		++ps;
-	}
-}
-
-/* form a "line" of input starting at the current buffer position, and
-stopping at a CR/LF.  Then return the first token from this "line". */
-	
-char *first_token ()
-{
-	int i, imax;
-	char *ts;
-
-	t = NULL;
-	ts = strtok (ps, "\n\r");  /* now ts is a NULL-terminated input line */
-	if (ts) {
-		while (*ts != '\0' && isspace (*ts)) {
-			++ts;
-		}
-		imax = strlen (ts);
-		ps += (imax + 1);      /* get ready for the next input line */
-		while (*ps != '\0' && isspace (*ps)) {
-			++ps;
-		}
-		t = strtok (ts, seps); /* initialize library function strtok */
-		if (t) {
-			if (t[0] == '*') { /* comment line - try again */
-				return first_token ();
-			}
-			imax = strlen (t);
-			for (i = 0; i < imax; i++) {
-				t[i] = (char) tolower (t[i]);  /* convert token to lower case */
-			}
-		} else {
-			return first_token ();
-		}
-	}
-	return (t);
-}
-
-/* pull the next char token out of the buffer, converted to lower case */
-
-char *next_token (void)
-{
-	int i, imax;
-	
-	t = strtok (NULL, seps);
-	if (t) {
-		imax = strlen (t);
-		for (i = 0; i < imax; i++) {
-			t[i] = (char) tolower (t[i]);
-		}
-	}
-	return (t);
-}
-
-/* read the rest of the line, case sensitive - usually a text label */
-
-char *rest_of_line (void)
-{
-	t = strtok (NULL, eat_line_seps);
-	return (t);
-}
-
-/* read the next int from buffer - this assumes that the next token
-is supposed to be an int - and if it isn't, there is an input error.
-Note program will eventually crash if next_token exists but is not an int.
-This doesn't happen in LPDWCALC, if input is properly prepared in driver.c
-*/
-
-int next_int (int *value)
-{
-	t = next_token ();
-	if (t) {
-		strcpy (ns, t);
-		*value = atoi (ns);  /* convert copy of token to int */
-		return (0);
-	} else {
-		*value = 0;  /* no more data */
-		return (1);
-	}
-}
-
-/* get the next double out of the buffer - again assuming that the next
-token is supposed to be a double
-Note program will eventually crash if next_token exists but is not a double.
-This doesn't happen in LPDWCALC, if input is properly prepared in driver.c
-*/
-
-int next_double (double *value)
-{
-	t = next_token ();
-	if (t) {
-		strcpy (ns, t);
-		*value = atof (ns);  /* convert copy of token to double */
-		return (0);
-	} else {
-		*value = 0.0;  /* no more data */
-		return (1);
-	}
-}
-
-/* get the first integer out of the buffer - as called from ltread.c, this
-also initializes the parser.  Otherwise, identical to next_int. */
-
-int first_int (char *sn, int *value)
-{
-	init_parser (sn);
-	t = first_token ();
-	if (t) {
-		strcpy (ns, t);
-		*value = atoi (ns);
-		return (0);
-	} else {
-		*value = 0;
-		return (1);
-	}
-}
-
-/* get the first double out of the buffer - as called from ltread.c, this
-also initializes the parser.  Otherwise, identical to next_double. */
-
-int first_double (char *sn, double *value)
-{
-	init_parser (sn);
-	t = first_token ();
-	if (t) {
-		strcpy (ns, t);
-		*value = atof (ns);
-		return (0);
-	} else {
-		*value = 0.0;
-		return (1);
-	}
-}
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* this module is used to parse transient simulation input from a char
+buffer in memory.  Each input line is copied into a line buffer when it is
+reached, and its tokens are cut off there and converted to lower case as
+they are read, so one pass over the deck reads it and the deck text is
+left as it was.  That lets the parser expand these lines in place:
+
+  include filename
+      parse the lines of another file here; each file is read once
+  repeat name first last [step]
+  ...
+  endrepeat
+      parse the lines in between once for each value of name, where
+      a token $name, $name+k or $name-k stands for the current value
+
+A repeat may hold includes and other repeats, and an included file may
+hold repeats, as long as each repeat ends in the file where it began. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "OETypes.h"
+#include "Parser.h"
+
+#define EXACT_POWERS 22  /* 10^0 through 10^22 are exact doubles */
+#define EXACT_MANTISSA 9007199254740992ULL  /* 2^53 */
+
+#define MAX_FRAMES 32  /* nested includes and repeats */
+#define MAX_NAME 32
+#define VALUE_TOKENS 4  /* substituted tokens stay valid for this many more tokens */
+#define VALUE_SIZE 16
+
+#define FRAME_INCLUDE 0
+#define FRAME_REPEAT 1
+
+static char include_token[] = "include";
+static char repeat_token[] = "repeat";
+static char endrepeat_token[] = "endrepeat";
+
+struct parse_frame {
+	int kind;
+	char *resume;  /* include: the parent's next line; repeat: the first line of the body */
+	char name[MAX_NAME];  /* repeat variable, and its values */
+	int value;
+	int last;
+	int step;
+};
+
+struct include_file {  /* text of an included file, kept till the parse is done */
+	char *name;
+	char *text;
+	struct include_file *next;
+};
+
+static char *next_line;  /* start of the next input line, NULL at the end of the input */
+static char *pos;  /* next character of the current line, NULL before the first line */
+static char *line_buf = NULL;  /* copy of the current line */
+static size_t line_size = 0;
+static struct parse_frame frames [MAX_FRAMES];
+static int depth = 0;
+static struct include_file *includes = NULL;
+static char values [VALUE_TOKENS][VALUE_SIZE];
+static int next_value = 0;
+
+static const double powers_of_ten [EXACT_POWERS + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static void deck_error (char *msg, char *detail)
+{
+	if (logfp) fprintf (logfp, "%s %s\n", msg, detail ? detail : "");
+	oe_exit (ERR_DECK_STRUCTURE);
+}
+
+/*  &&&&  input file parsing functions  */
+
+void init_parser (char *sn)
+{
+	next_line = sn;
+	pos = NULL;
+	depth = 0;
+}
+
+void free_parser (void)
+{
+	struct include_file *f;
+
+	while (includes) {
+		f = includes->next;
+		free (includes->name);
+		free (includes->text);
+		free (includes);
+		includes = f;
+	}
+	free (line_buf);
+	line_buf = NULL;
+	line_size = 0;
+	depth = 0;
+}
+
+static int is_separator (char c)
+{
+	return (c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\a' || c == '\b');
+}
+
+/* a token $name, $name+k or $name-k, for the innermost repeat of that name */
+
+static char *substitute (char *t)
+{
+	char *op;
+	int i, len, offset = 0;
+
+	op = strpbrk (t + 1, "+-");
+	len = op ? (int) (op - t - 1) : (int) strlen (t + 1);
+	if (op) offset = atoi (op);
+	for (i = depth - 1; i >= 0; i--) {
+		if (frames[i].kind == FRAME_REPEAT && (int) strlen (frames[i].name) == len
+			&& !strncmp (frames[i].name, t + 1, len)) {
+			next_value = (next_value + 1) % VALUE_TOKENS;
+			sprintf (values[next_value], "%d", frames[i].value + offset);
+			return (values[next_value]);
+		}
+	}
+	deck_error ("no repeat defines", t);
+	return (t);
+}
+
+/* cut off the next token of the current line, in lower case */
+
+static char *scan_token (void)
+{
+	char *t, *p;
+
+	if (!pos) return (NULL);
+	p = pos;
+	while (is_separator (*p)) {
+		++p;
+	}
+	if (*p == '\0') {
+		pos = p;
+		return (NULL);
+	}
+	t = p;
+	while (*p != '\0' && !is_separator (*p)) {
+		*p = (char) tolower (*p);
+		++p;
+	}
+	if (*p != '\0') {
+		*p++ = '\0';
+	}
+	pos = p;
+	if (t[0] == '$' && depth > 0) {
+		return (substitute (t));
+	}
+	return (t);
+}
+
+/* copy the next non-blank input line into line_buf, and return 0 when there
+are no more lines in this file */
+
+static int copy_line (void)
+{
+	char *p, *start;
+	size_t len;
+
+	if (!next_line) return (0);
+	p = next_line;
+	while (*p != '\0' && isspace (*p)) {
+		++p;
+	}
+	if (*p == '\0') {
+		return (0);
+	}
+	start = p;
+	while (*p != '\0' && *p != '\n' && *p != '\r') {
+		++p;
+	}
+	len = (size_t) (p - start);
+	next_line = p;  /* get ready for the next input line */
+	if (len + 1 > line_size) {
+		line_size = 2 * len + 64;
+		free (line_buf);
+		if ((line_buf = (char *) malloc (line_size)) == NULL) {
+			if (logfp) fprintf (logfp, "can't allocate input line\n");
+			oe_exit (ERR_MALLOC);
+		}
+	}
+	memcpy (line_buf, start, len);
+	line_buf[len] = '\0';
+	pos = line_buf;
+	return (1);
+}
+
+static void push_frame (int kind, char *resume)
+{
+	if (depth >= MAX_FRAMES) {
+		deck_error ("too many nested includes and repeats", NULL);
+	}
+	frames[depth].kind = kind;
+	frames[depth].resume = resume;
+	++depth;
+}
+
+static char *read_include (char *name)
+{
+	struct include_file *f;
+	FILE *fp;
+	long size = 0;
+
+	for (f = includes; f; f = f->next) {
+		if (!strcmp (f->name, name)) return (f->text);
+	}
+	if ((fp = fopen (name, "rb")) == NULL) {
+		deck_error ("can't open include file", name);
+	}
+	if (fseek (fp, 0L, SEEK_END) || (size = ftell (fp)) < 0 || fseek (fp, 0L, SEEK_SET)) {
+		deck_error ("can't read include file", name);
+	}
+	f = (struct include_file *) malloc (sizeof *f);
+	if (!f || (f->name = (char *) malloc (strlen (name) + 1)) == NULL
+		|| (f->text = (char *) malloc ((size_t) size + 1)) == NULL) {
+		if (logfp) fprintf (logfp, "can't allocate include file %s\n", name);
+		oe_exit (ERR_MALLOC);
+	}
+	strcpy (f->name, name);
+	f->text[fread (f->text, 1, (size_t) size, fp)] = '\0';
+	fclose (fp);
+	f->next = includes;
+	includes = f;
+	return (f->text);
+}
+
+static void start_include (void)
+{
+	char *name, *end;
+
+	name = pos;
+	while (is_separator (*name)) {
+		++name;
+	}
+	end = name + strlen (name);
+	while (end > name && is_separator (end[-1])) {
+		*--end = '\0';
+	}
+	if (*name == '\0') {
+		deck_error ("missing include file name", NULL);
+	}
+	push_frame (FRAME_INCLUDE, next_line);
+	next_line = read_include (name);
+}
+
+/* pass over a repeat body that runs no times, including any nested repeats */
+
+static void skip_repeat (void)
+{
+	char *t;
+	int nested = 0;
+
+	while (copy_line ()) {
+		t = scan_token ();
+		if (!strcmp (t, repeat_token)) {
+			++nested;
+		} else if (!strcmp (t, endrepeat_token) && nested-- == 0) {
+			return;
+		}
+	}
+	deck_error ("missing", endrepeat_token);
+}
+
+static void start_repeat (void)
+{
+	struct parse_frame *f;
+	char *t;
+
+	t = scan_token ();
+	if (!t || strlen (t) >= MAX_NAME || isdigit (t[0])) {
+		deck_error ("repeat needs a name, not", t);
+	}
+	push_frame (FRAME_REPEAT, next_line);
+	f = &frames[depth - 1];
+	strcpy (f->name, t);
+	if (next_int (&f->value) || next_int (&f->last)) {
+		deck_error ("repeat needs first and last values for", f->name);
+	}
+	if (next_int (&f->step)) {
+		f->step = 1;
+	}
+	if (f->step == 0) {
+		deck_error ("repeat step can't be zero for", f->name);
+	}
+	if ((f->step > 0 && f->value > f->last) || (f->step < 0 && f->value < f->last)) {
+		--depth;
+		skip_repeat ();
+	}
+}
+
+static void end_repeat (void)
+{
+	struct parse_frame *f;
+
+	if (depth < 1 || frames[depth - 1].kind != FRAME_REPEAT) {
+		deck_error (endrepeat_token, "without a repeat");
+	}
+	f = &frames[depth - 1];
+	f->value += f->step;
+	if ((f->step > 0 && f->value <= f->last) || (f->step < 0 && f->value >= f->last)) {
+		next_line = f->resume;
+	} else {
+		--depth;
+	}
+}
+
+/* form a "line" of input starting at the current input position, and
+stopping at a CR/LF.  Then return the first token from this "line".
+Blank lines and comment lines, which start with '*', are passed over,
+and include and repeat lines are carried out. */
+	
+char *first_token (void)
+{
+	char *t;
+
+	for (;;) {
+		if (!copy_line ()) {
+			if (depth > 0 && frames[depth - 1].kind == FRAME_INCLUDE) {
+				next_line = frames[--depth].resume;  /* back to the including file */
+				continue;
+			}
+			if (depth > 0) {
+				deck_error ("missing", endrepeat_token);
+			}
+			next_line = NULL;
+			pos = NULL;
+			return (NULL);
+		}
+		t = scan_token ();
+		if (!t || t[0] == '*') {
+			continue;
+		} else if (!strcmp (t, include_token)) {
+			start_include ();
+		} else if (!strcmp (t, repeat_token)) {
+			start_repeat ();
+		} else if (!strcmp (t, endrepeat_token)) {
+			end_repeat ();
+		} else {
+			return (t);
+		}
+	}
+}
+
+/* pull the next char token out of the current line, converted to lower case */
+
+char *next_token (void)
+{
+	return (scan_token ());
+}
+
+/* read the rest of the line, case sensitive - usually a text label */
+
+char *rest_of_line (void)
+{
+	char *t;
+
+	if (!pos || *pos == '\0') return (NULL);
+	t = pos;
+	pos += strlen (t);
+	return (t);
+}
+
+/* the token as a number, the way atoi and atof read it.  A decimal number
+whose digits m fit in 53 bits, with a power of ten e no larger than 22,
+is converted directly, since m * 10^e and m / 10^e round correctly when
+both are exact doubles.  Anything else goes to strtod. */
+
+static int token_int (char *s)
+{
+	int value = 0, negative = 0;
+	char *p = s;
+
+	if (*p == '-' || *p == '+') {
+		negative = (*p++ == '-');
+	}
+	while (isdigit (*p) && value < 100000000) {
+		value = 10 * value + (*p++ - '0');
+	}
+	if (isdigit (*p)) return (atoi (s));
+	return (negative ? -value : value);
+}
+
+static double token_double (char *s)
+{
+	unsigned long long m = 0;
+	int digits = 0, e = 0, ex = 0, negative = 0, negative_ex = 0;
+	char *p = s;
+	double value;
+
+	if (*p == '-' || *p == '+') {
+		negative = (*p++ == '-');
+	}
+	while (isdigit (*p)) {
+		m = 10 * m + (unsigned long long) (*p++ - '0');
+		++digits;
+	}
+	if (*p == '.') {
+		++p;
+		while (isdigit (*p)) {
+			m = 10 * m + (unsigned long long) (*p++ - '0');
+			++digits;
+			--e;
+		}
+	}
+	if (digits == 0 || digits > 19) return (strtod (s, NULL));
+	if (*p == 'e' || *p == 'E') {
+		++p;
+		if (*p == '-' || *p == '+') {
+			negative_ex = (*p++ == '-');
+		}
+		if (!isdigit (*p)) return (strtod (s, NULL));
+		while (isdigit (*p) && ex < 1000) {
+			ex = 10 * ex + (*p++ - '0');
+		}
+		e += negative_ex ? -ex : ex;
+	}
+	if (*p != '\0' || m > EXACT_MANTISSA || e > EXACT_POWERS || e < -EXACT_POWERS) {
+		return (strtod (s, NULL));
+	}
+	value = (double) m;
+	if (e > 0) {
+		value *= powers_of_ten [e];
+	} else if (e < 0) {
+		value /= powers_of_ten [-e];
+	}
+	return (negative ? -value : value);
+}
+
+/* read the next int from buffer - this assumes that the next token
+is supposed to be an int - and if it isn't, there is an input error.
+Note program will eventually crash if next_token exists but is not an int.
+This doesn't happen in LPDWCALC, if input is properly prepared in driver.c
+*/
+
+int next_int (int *value)
+{
+	char *t = next_token ();
+
+	if (t) {
+		*value = token_int (t);
+		return (0);
+	} else {
+		*value = 0;  /* no more data */
+		return (1);
+	}
+}
+
+/* get the next double out of the buffer - again assuming that the next
+token is supposed to be a double
+Note program will eventually crash if next_token exists but is not a double.
+This doesn't happen in LPDWCALC, if input is properly prepared in driver.c
+*/
+
+int next_double (double *value)
+{
+	char *t = next_token ();
+
+	if (t) {
+		*value = token_double (t);
+		return (0);
+	} else {
+		*value = 0.0;  /* no more data */
+		return (1);
+	}
+}
+
+/* get the first integer out of the buffer - as called from ltread.c, this
+also initializes the parser.  Otherwise, identical to next_int. */
+
+int first_int (char *sn, int *value)
+{
+	char *t;
+
+	init_parser (sn);
+	t = first_token ();
+	if (t) {
+		*value = token_int (t);
+		return (0);
+	} else {
+		*value = 0;
+		return (1);
+	}
+}
+
+/* get the first double out of the buffer - as called from ltread.c, this
+also initializes the parser.  Otherwise, identical to next_double. */
+
+int first_double (char *sn, double *value)
+{
+	char *t;
+
+	init_parser (sn);
+	t = first_token ();
+	if (t) {
+		*value = token_double (t);
+		return (0);
+	} else {
+		*value = 0.0;
+		return (1);
+	}
+}
@@ -0,0 +1,526 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This file contains functions to carry the derivatives of the pole
+voltages, and of the component history terms, with respect to the stroke
+peak current.  The tangent system at each step has the same pole matrices
+as the simulation, so it reuses their factors.  Nonlinear components are
+linearized at the converged solution of the step, and their switching
+instants are taken as fixed. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_linalg.h>
+
+#include "OETypes.h"
+#include "OEEngine.h"
+#include "ChangeTimeStep.h"
+#include "Sensitivity.h"
+#include "AllComponents.h"
+
+int want_sensitivity = FALSE;
+
+static gsl_vector *tangent_vector (gsl_vector *v, size_t n)
+{
+	if (!v && !(v = gsl_vector_alloc (n))) {
+		if (logfp) fprintf (logfp, "can't allocate sensitivity vector\n");
+		oe_exit (ERR_MALLOC);
+	}
+	gsl_vector_set_zero (v);
+	return v;
+}
+
+static gsl_matrix *tangent_matrix (gsl_matrix *m, size_t n1, size_t n2)
+{
+	if (!m && !(m = gsl_matrix_alloc (n1, n2))) {
+		if (logfp) fprintf (logfp, "can't allocate sensitivity matrix\n");
+		oe_exit (ERR_MALLOC);
+	}
+	gsl_matrix_set_zero (m);
+	return m;
+}
+
+static double branch_tangent (struct pole *p, int from, int to)
+{
+	return gsl_vector_get (p->dvoltage, from) - gsl_vector_get (p->dvoltage, to);
+}
+
+/* the initial conditions don't depend on the stroke, so all tangents start at zero */
+
+static void reset_pole_tangent (struct pole *ptr)
+{
+	ptr->dvoltage = tangent_vector (ptr->dvoltage, number_of_nodes + 1);
+	ptr->dinjection = tangent_vector (ptr->dinjection, number_of_nodes + 1);
+	ptr->dvmode = tangent_vector (ptr->dvmode, number_of_nodes);
+	ptr->dimode = tangent_vector (ptr->dimode, number_of_nodes);
+}
+
+static void reset_line_tangent (struct line *ptr)
+{
+	ptr->dhist_left = tangent_matrix (ptr->dhist_left, number_of_conductors, ptr->alloc_steps);
+	ptr->dhist_right = tangent_matrix (ptr->dhist_right, number_of_conductors, ptr->alloc_steps);
+}
+
+static void reset_ground_tangent (struct ground *ptr)
+{
+	ptr->dh = ptr->di = 0.0;
+}
+
+static void reset_arrester_tangent (struct arrester *ptr)
+{
+	ptr->dh = ptr->di = ptr->di_past = 0.0;
+}
+
+static void reset_arrbez_tangent (struct arrbez *ptr)
+{
+	ptr->dh = ptr->dg = ptr->damps = 0.0;
+}
+
+static void reset_inductor_tangent (struct inductor *ptr)
+{
+	ptr->dh = 0.0;
+}
+
+static void reset_capacitor_tangent (struct capacitor *ptr)
+{
+	ptr->dh = 0.0;
+}
+
+static void reset_insulator_tangent (struct insulator *ptr)
+{
+	ptr->dde_pos = ptr->dde_neg = 0.0;
+}
+
+/* the tangent times the stroke peak is in volts, so it is kept to
+wave_quantum volts at this peak */
+
+static void reset_lpm_tangent (struct lpm *ptr)
+{
+	struct surge *s = surge_head->next;
+	struct steepfront *sf = steepfront_head->next;
+	double peak = s ? s->peak : (sf ? sf->peak : 0.0);
+
+	reset_wave_code (&ptr->dpts);
+	ptr->dpts.quantum = (fabs (peak) > 0.0) ? wave_quantum / fabs (peak) : wave_quantum;
+}
+
+void reset_sensitivity (void)
+{
+	do_all_poles (reset_pole_tangent);
+	do_all_lines (reset_line_tangent);
+	do_all_grounds (reset_ground_tangent);
+	do_all_arresters (reset_arrester_tangent);
+	do_all_arrbezs (reset_arrbez_tangent);
+	do_all_inductors (reset_inductor_tangent);
+	do_all_capacitors (reset_capacitor_tangent);
+	do_all_insulators (reset_insulator_tangent);
+	do_all_lpms (reset_lpm_tangent);
+}
+
+/* injections, mirroring the inject_ functions of each component */
+
+static void zero_pole_tangent (struct pole *ptr)
+{
+	gsl_vector_set_zero (ptr->dinjection);
+	gsl_vector_set_zero (ptr->dimode);
+}
+
+static void add_branch_tangent (struct pole *p, int from, int to, double val)
+{
+	*gsl_vector_ptr (p->dinjection, from) += val;
+	*gsl_vector_ptr (p->dinjection, to) -= val;
+}
+
+/* both stroke shapes scale with the peak current, as run_loop_case sets it */
+
+static void inject_stroke_tangent (void)
+{
+	struct surge *s = surge_head->next;
+	struct steepfront *sf = steepfront_head->next;
+	double shape;
+
+	if (s) {
+		shape = surge_unit (s);
+		if (t > s->tstart) {
+			add_branch_tangent (s->parent, s->from, s->to, shape);
+		}
+	} else if (sf) {
+		shape = steepfront_unit (sf);
+		if (t > sf->tstart) {
+			add_branch_tangent (sf->parent, sf->from, sf->to, shape);
+		}
+	}
+}
+
+static void inject_ground_tangent (struct ground *ptr)
+{
+	add_branch_tangent (ptr->parent, ptr->from, ptr->to, -ptr->di);
+}
+
+static void inject_arrester_tangent (struct arrester *ptr)
+{
+	if (ptr->conducting) {
+		add_branch_tangent (ptr->parent, ptr->from, ptr->to, -ptr->di_past);
+	}
+}
+
+static void inject_inductor_tangent (struct inductor *ptr)
+{
+	add_branch_tangent (ptr->parent, ptr->from, ptr->to, -ptr->dh);
+}
+
+static void inject_capacitor_tangent (struct capacitor *ptr)
+{
+	add_branch_tangent (ptr->parent, ptr->from, ptr->to, -ptr->dh);
+}
+
+static void inject_line_imode_tangent (struct line *ptr)
+{
+	int i, k;
+
+	k = step % ptr->steps;
+	for (i = 0; i < number_of_conductors; i++) {
+		*gsl_vector_ptr (ptr->left->dimode, i) -= gsl_matrix_get (ptr->dhist_left, i, k);
+		*gsl_vector_ptr (ptr->right->dimode, i) -= gsl_matrix_get (ptr->dhist_right, i, k);
+	}
+}
+
+static void inject_pole_imode_tangent (struct pole *ptr)
+{
+	gsl_vector_view rhs;
+
+	if (ptr->solve) {
+		rhs = gsl_vector_subvector (ptr->dinjection, 1, number_of_nodes);
+		gsl_blas_dgemv (CblasNoTrans, 1.0, span_head->Ti, ptr->dimode, 1.0, &rhs.vector);
+	}
+}
+
+static void inject_line_iphase_tangent (struct line *ptr)
+{
+	struct pole *p;
+	gsl_matrix *h;
+	gsl_vector_view ip;
+	int i, k, end;
+
+	k = step % ptr->steps;
+	for (end = 0; end < 2; end++) {
+		p = end ? ptr->right : ptr->left;
+		h = end ? ptr->dhist_right : ptr->dhist_left;
+		for (i = 0; i < number_of_conductors; i++) {
+			gsl_vector_set (p->dimode, i, -gsl_matrix_get (h, i, k));
+		}
+		ip = gsl_vector_subvector (p->dinjection, 1, number_of_nodes);
+		gsl_blas_dgemv (CblasNoTrans, 1.0, ptr->defn->Ti, p->dimode, 1.0, &ip.vector);
+	}
+}
+
+/* Solve for the voltage tangents with the factors from the last triang_pole.
+At poles with arrbez, the converged currents satisfy
+  (Rthev + r) i + v(i) = voc
+so the current tangents come from the same Jacobian as solve_pole, with
+dv/di = 1 / slope of the arrester curve.  These are compensated into the
+tangent injections just as solve_pole does with the currents. */
+
+static void solve_pole_tangent (struct pole *ptr)
+{
+	struct arrbez *aptr;
+	int i, j, k, m, signum;
+	double dvoc, slope;
+	gsl_vector_view rhs, inj;
+
+	if (!ptr->solve) {
+		return;
+	}
+	rhs = gsl_vector_subvector (ptr->dvoltage, 1, number_of_nodes);
+	inj = gsl_vector_subvector (ptr->dinjection, 1, number_of_nodes);
+	gsl_vector_memcpy (&rhs.vector, &inj.vector);
+	gsl_linalg_LU_svx (ptr->y, ptr->perm, &rhs.vector);
+	if (ptr->num_nonlinear < 1) {
+		return;
+	}
+	for (i = 0; i < ptr->num_nonlinear; i++) {
+		aptr = ptr->backptr[i];
+		k = aptr->from;
+		m = aptr->to;
+		dvoc = 0.0;
+		if (k > 0) dvoc += gsl_vector_get (ptr->dvoltage, k);
+		if (m > 0) dvoc -= gsl_vector_get (ptr->dvoltage, m);
+		if (aptr->rl > 0.0) {
+			dvoc += aptr->dh * aptr->rl;
+		}
+		dvoc += aptr->amps * aptr->dg / (aptr->g * aptr->g);  /* -i dr, with r = rl + rgap + 1/g */
+		slope = bez_d1 (aptr->shape, aptr->varr);
+		if (slope > 0.0) {
+			for (j = 0; j < ptr->num_nonlinear; j++) {
+				gsl_matrix_set (ptr->jacobian, i, j, gsl_matrix_get (ptr->Rthev, i, j));
+			}
+			*gsl_matrix_ptr (ptr->jacobian, i, i) += aptr->r + 1.0 / slope;
+			gsl_vector_set (ptr->f, i, dvoc);
+		} else {  /* no conduction, so no change in current */
+			for (j = 0; j < ptr->num_nonlinear; j++) {
+				gsl_matrix_set (ptr->jacobian, i, j, 0.0);
+			}
+			gsl_matrix_set (ptr->jacobian, i, i, 1.0);
+			gsl_vector_set (ptr->f, i, 0.0);
+		}
+	}
+	gsl_linalg_LU_decomp (ptr->jacobian, ptr->jperm, &signum);
+	gsl_linalg_LU_svx (ptr->jacobian, ptr->jperm, ptr->f);
+	ptr->jfactored = FALSE;  /* solve_pole can't keep these for chord steps */
+	for (i = 0; i < ptr->num_nonlinear; i++) {
+		aptr = ptr->backptr[i];
+		k = aptr->from;
+		m = aptr->to;
+		aptr->damps = gsl_vector_get (ptr->f, i);
+		if (aptr->rl > 0.0) {
+			aptr->dh += aptr->gl * aptr->rl * (aptr->damps - aptr->dh);
+		}
+		if (k > 0) *gsl_vector_ptr (ptr->dinjection, k) -= aptr->damps;
+		if (m > 0) *gsl_vector_ptr (ptr->dinjection, m) += aptr->damps;
+	}
+	gsl_vector_memcpy (&rhs.vector, &inj.vector);
+	gsl_linalg_LU_svx (ptr->y, ptr->perm, &rhs.vector);
+}
+
+/* history updates, mirroring the check_ and update_ functions.  These run
+before the simulation updates its own histories, so the state of the step
+just solved is still available. */
+
+static void update_ground_tangent (struct ground *ptr)
+{
+	double It, dIt, Vt, dVt, Imag, dImag, Ri, dRi, Vg, dVg, di_bias;
+
+	Vt = gsl_vector_get (ptr->parent->voltage, ptr->from) - gsl_vector_get (ptr->parent->voltage, ptr->to);
+	dVt = branch_tangent (ptr->parent, ptr->from, ptr->to);
+	It = Vt * ptr->y + ptr->i;
+	dIt = dVt * ptr->y + ptr->di;
+	Imag = fabs (It);
+	dImag = It < 0.0 ? -dIt : dIt;
+	Ri = ptr->R60 / sqrt (1.0 + Imag / ptr->Ig);
+	dRi = -0.5 * Ri * dImag / (ptr->Ig + Imag);
+	Vg = It * Ri;
+	dVg = dIt * Ri + It * dRi;
+	di_bias = dVg * (1.0 / Ri - ptr->y60) - Vg * dRi / (Ri * Ri);
+	if (ptr->zl > 0.0) {
+		ptr->dh = dIt + (dVt - dVg) / ptr->zl;
+	}
+	ptr->di = ptr->dh * ptr->yzl + di_bias * ptr->yr;
+}
+
+/* check_arrester has already run on this solution.  If the arrester is
+still conducting, it computed h and i from these voltages; otherwise they
+were set to zero. */
+
+static void update_arrester_tangent (struct arrester *ptr)
+{
+	double dvolts, damps;
+
+	if (ptr->conducting) {
+		dvolts = branch_tangent (ptr->parent, ptr->from, ptr->to);
+		damps = dvolts * ptr->y + ptr->di_past;
+		if (ptr->zl > 0.0) {
+			ptr->dh = damps + (dvolts - ptr->r_slope * damps) / ptr->zl;
+		}
+		ptr->di = ptr->dh * ptr->yzl;
+	} else {
+		ptr->dh = ptr->di = 0.0;
+	}
+	ptr->di_past = ptr->di;
+}
+
+static void update_arrbez_tangent (struct arrbez *ptr)
+{
+	double Ipu, Vpu, Gpu, Vgap, dVgap, dVpu, c, dG;
+	struct pole *p;
+
+	if (ptr->rgap > 0.0) {  /* gap has not sparked over */
+		return;
+	}
+	if (ptr->Uref > 0.0 && ptr->g < SHORT_CIRCUIT_G) {
+		p = ptr->parent;
+		Vgap = gsl_vector_get (p->voltage, ptr->from) - gsl_vector_get (p->voltage, ptr->to);
+		dVgap = branch_tangent (p, ptr->from, ptr->to);
+		Ipu = ptr->amps / ARRBEZ_IREF;
+		Vpu = fabs (Vgap) / ptr->Uref;
+		dVpu = (Vgap < 0.0 ? -dVgap : dVgap) / ptr->Uref;
+		Gpu = ptr->g / ptr->Gref;
+		c = (ptr->Gref / ARRBEZ_TREF) * exp (Vpu);
+		dG = c * ((1.0 + Gpu * Ipu * Ipu) + (1.0 + Gpu) * Ipu * Ipu) * ptr->dg / ptr->Gref
+			+ c * (1.0 + Gpu) * 2.0 * Gpu * Ipu * ptr->damps / ARRBEZ_IREF
+			+ c * (1.0 + Gpu) * (1.0 + Gpu * Ipu * Ipu) * dVpu;
+		ptr->dg += dG * dT;
+	}
+}
+
+static void update_inductor_tangent (struct inductor *ptr)
+{
+	ptr->dh = ptr->zi * ptr->dh + ptr->yi * branch_tangent (ptr->parent, ptr->from, ptr->to);
+}
+
+static void update_capacitor_tangent (struct capacitor *ptr)
+{
+	ptr->dh = ptr->yc * branch_tangent (ptr->parent, ptr->to, ptr->from) - ptr->dh;
+}
+
+static void update_insulator_tangent (struct insulator *ptr)
+{
+	double volts, mag, dinc;
+	struct pole *p;
+
+	if (ptr->flashed || dT_switched) {
+		return;
+	}
+	p = ptr->parent;
+	volts = gsl_vector_get (p->voltage, ptr->from) - gsl_vector_get (p->voltage, ptr->to);
+	mag = fabs (volts) - ptr->vb;
+	if (mag > 0.0) {
+		dinc = ptr->beta * pow (mag, ptr->beta - 1.0) * branch_tangent (p, ptr->from, ptr->to) * dT;
+		if (volts >= 0.0) {
+			ptr->dde_pos += dinc;
+		} else {
+			ptr->dde_neg -= dinc;
+		}
+	}
+}
+
+static void update_lpm_tangent (struct lpm *ptr)
+{
+	struct pole *p = ptr->parent;
+	int i;
+
+	if (dT_switched) return;
+	if (ptr->flash_mode != LPM_FLASHED) {  /* keep it where check_lpm will keep the voltage */
+		i = next_lpm_sample (ptr, gsl_vector_get (p->voltage, ptr->from) - gsl_vector_get (p->voltage, ptr->to));
+		if (i == ptr->dpts.n) {
+			append_wave_code (&ptr->dpts, branch_tangent (p, ptr->from, ptr->to));
+		}
+	}
+}
+
+static void calc_pole_vmode_tangent (struct pole *ptr)
+{
+	int i;
+	gsl_vector_view rhs;
+
+	if (ptr->solve) {
+		rhs = gsl_vector_subvector (ptr->dvoltage, 1, number_of_nodes);
+		gsl_blas_dgemv (CblasNoTrans, 1.0, span_head->Tvt, &rhs.vector, 0.0, ptr->dvmode);
+	} else {
+		for (i = 0; i < number_of_conductors; i++) {
+			gsl_vector_set (ptr->dvmode, i, gsl_vector_get (ptr->dimode, i) * gsl_matrix_get (span_head->Zm, i, i) * 0.5);
+		}
+	}
+}
+
+static void update_line_tangent (struct line *ptr)
+{
+	double y, irl, ilr;
+	int i, k;
+
+	k = step % ptr->steps;
+	for (i = 0; i < number_of_conductors; i++) {
+		y = gsl_matrix_get (ptr->defn->Ym, i, i);
+		ilr = gsl_vector_get (ptr->left->dvmode, i) * y + gsl_matrix_get (ptr->dhist_left, i, k);
+		irl = gsl_vector_get (ptr->right->dvmode, i) * y + gsl_matrix_get (ptr->dhist_right, i, k);
+		gsl_matrix_set (ptr->dhist_left, i, k, -gsl_vector_get (ptr->right->dvmode, i) * y - irl);
+		gsl_matrix_set (ptr->dhist_right, i, k, -gsl_vector_get (ptr->left->dvmode, i) * y - ilr);
+	}
+}
+
+static void update_line_iphase_tangent (struct line *ptr)
+{
+	gsl_vector_view vp;
+
+	vp = gsl_vector_subvector (ptr->left->dvoltage, 1, number_of_conductors);
+	gsl_blas_dgemv (CblasNoTrans, 1.0, ptr->defn->Tvt, &vp.vector, 0.0, ptr->left->dvmode);
+	vp = gsl_vector_subvector (ptr->right->dvoltage, 1, number_of_conductors);
+	gsl_blas_dgemv (CblasNoTrans, 1.0, ptr->defn->Tvt, &vp.vector, 0.0, ptr->right->dvmode);
+	update_line_tangent (ptr);
+}
+
+/* after switching to the second dT, insulators and LPMs are no longer
+integrated, so the SI tangents can't change */
+
+void sensitivity_step (void)
+{
+	if (dT_switched) return;
+	do_all_poles (zero_pole_tangent);
+	inject_stroke_tangent ();
+	do_all_grounds (inject_ground_tangent);
+	if (using_multiple_span_defns) {
+		do_all_lines (inject_line_iphase_tangent);
+	} else {
+		do_all_lines (inject_line_imode_tangent);
+		do_all_poles (inject_pole_imode_tangent);
+	}
+	do_all_arresters (inject_arrester_tangent);
+	do_all_inductors (inject_inductor_tangent);
+	do_all_capacitors (inject_capacitor_tangent);
+	do_all_poles (solve_pole_tangent);
+	do_all_grounds (update_ground_tangent);
+	do_all_insulators (update_insulator_tangent);
+	do_all_lpms (update_lpm_tangent);
+	do_all_inductors (update_inductor_tangent);
+	do_all_arresters (update_arrester_tangent);
+	do_all_arrbezs (update_arrbez_tangent);
+	do_all_capacitors (update_capacitor_tangent);
+	if (using_multiple_span_defns) {
+		do_all_lines (update_line_iphase_tangent);
+	} else {
+		do_all_poles (calc_pole_vmode_tangent);
+		do_all_lines (update_line_tangent);
+	}
+}
+
+/* dSI comes from the insulator or LPM that set the SI answer.  With
+SI = (de / de_max) ^ (1 / beta), dSI = SI * dde / (beta * de).  It is
+left at zero if that component flashed over. */
+
+void sensitivity_answers (LPLTOUTSTRUCT answers)
+{
+	double de, dde;
+
+	answers->dSI = 0.0;
+	insulator_ptr = insulator_head;
+	while ((insulator_ptr = insulator_ptr->next) != NULL) {
+		if (!insulator_ptr->flashed && insulator_ptr->SI == answers->SI) {
+			if (insulator_ptr->de_neg > insulator_ptr->de_pos) {
+				de = insulator_ptr->de_neg;
+				dde = insulator_ptr->dde_neg;
+			} else {
+				de = insulator_ptr->de_pos;
+				dde = insulator_ptr->dde_pos;
+			}
+			if (de > 0.0) {
+				answers->dSI = insulator_ptr->SI * dde / (insulator_ptr->beta * de);
+			}
+		}
+	}
+	lpm_ptr = lpm_head;
+	while ((lpm_ptr = lpm_ptr->next) != NULL) {
+		if (lpm_ptr->flash_mode != LPM_FLASHED && lpm_ptr->SI == answers->SI) {
+			answers->dSI = calculate_lpm_dsi (lpm_ptr);
+		}
+	}
+}
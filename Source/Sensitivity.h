@@ -0,0 +1,33 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef sensitivity_included
+#define sensitivity_included
+
+/* Forward-mode derivatives of the simulation with respect to the peak
+current of the stroke, i.e. the first surge or steepfront in the list. */
+
+extern int want_sensitivity;  /* TRUE to carry the tangent state */
+
+void reset_sensitivity (void);  /* zero the tangent state, before each simulation */
+void sensitivity_step (void);   /* after each valid solution, before updating the histories */
+void sensitivity_answers (LPLTOUTSTRUCT answers);  /* dSI, after the answers cleanup */
+
+#endif
@@ -0,0 +1,297 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This file contains functions to simulate only the part of a long line
+that a stroke can reach before Tmax.
+
+With uniform spans of travel time tau, a wave leaving the struck pole s
+reaches pole p at |s - p| * tau.  If the window edge b is terminated in
+its surge impedance, the first change from the full model appears at b
+when the stroke wave arrives there, and it reaches pole q after another
+|b - q| * tau.  The window half-width H is chosen so that |s - b| + |b - q|
+exceeds the reach N = Tmax / tau for every pole q with an insulator or LPM
+that the stroke can reach.  Their answers are then the same as in the full
+model, while poles, lines and components outside the window are parked. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+
+#include "OETypes.h"
+#include "SpatialWindow.h"
+#include "ChangeTimeStep.h"
+#include "AllComponents.h"
+
+#define PARK_BY_PARENT 0
+#define PARK_POLE      1
+#define PARK_LINE      2
+#define PARK_STROKE    3
+#define MAX_PARKED    16
+
+/* the component lists have different node types, but all of them link
+through a next pointer, and most have a parent pole pointer */
+
+struct parked_list {
+	int kind;
+	char *head;             /* the list's dummy head node */
+	size_t next_offset;
+	size_t parent_offset;
+	int count;
+	char **nodes;           /* all nodes in their original order */
+};
+
+struct window_edge {
+	struct pole *pole;
+	int solve;              /* original value, restored on closing */
+	gsl_matrix *Ybus;
+};
+
+int window_first_pole;
+int window_last_pole;
+
+static struct parked_list parked [MAX_PARKED];
+static int number_parked = 0;
+static struct window_edge edges [2];
+static int number_of_edges = 0;
+static struct source *source_tail = NULL;  /* window terminations follow this one */
+
+static char *get_link (char *node, size_t offset)
+{
+	char *link;
+
+	memcpy (&link, node + offset, sizeof link);
+	return link;
+}
+
+static void set_link (char *node, size_t offset, char *link)
+{
+	memcpy (node + offset, &link, sizeof link);
+}
+
+static int in_window (struct pole *ptr)
+{
+	return ptr->location >= window_first_pole && ptr->location <= window_last_pole;
+}
+
+static int keep_node (struct parked_list *pl, char *node)
+{
+	struct line *ln;
+
+	switch (pl->kind) {
+		case PARK_POLE:
+			return in_window ((struct pole *) node);
+		case PARK_LINE:
+			ln = (struct line *) node;
+			return in_window (ln->left) && in_window (ln->right);
+		default:
+			return in_window ((struct pole *) get_link (node, pl->parent_offset));
+	}
+}
+
+static void add_list (int kind, char *head, size_t next_offset, size_t parent_offset)
+{
+	struct parked_list *pl = &parked [number_parked++];
+
+	pl->kind = kind;
+	pl->head = head;
+	pl->next_offset = next_offset;
+	pl->parent_offset = parent_offset;
+	pl->count = 0;
+	pl->nodes = NULL;
+}
+
+#define ADD_COMPONENT_LIST(type, head) add_list (PARK_BY_PARENT, (char *) head, \
+	offsetof (struct type, next), offsetof (struct type, parent))
+
+/* run_loop_case moves the first surge or steepfront to the struck pole
+after the window opens, so that one stays wherever the deck put it */
+#define ADD_STROKE_LIST(type, head) add_list (PARK_STROKE, (char *) head, \
+	offsetof (struct type, next), offsetof (struct type, parent))
+
+static void park_list (struct parked_list *pl)
+{
+	char *node, *prev;
+	int i;
+
+	pl->count = 0;
+	node = pl->head;
+	while ((node = get_link (node, pl->next_offset)) != NULL) {
+		++pl->count;
+	}
+	if (!(pl->nodes = (char **) malloc ((pl->count + 1) * sizeof (char *)))) {
+		if (logfp) fprintf (logfp, "can't allocate spatial window\n");
+		oe_exit (ERR_MALLOC);
+	}
+	i = 0;
+	node = pl->head;
+	while ((node = get_link (node, pl->next_offset)) != NULL) {
+		pl->nodes[i++] = node;
+	}
+	prev = pl->head;
+	for (i = 0; i < pl->count; i++) {
+		if ((pl->kind == PARK_STROKE && i == 0) || keep_node (pl, pl->nodes[i])) {
+			set_link (prev, pl->next_offset, pl->nodes[i]);
+			prev = pl->nodes[i];
+		}
+	}
+	set_link (prev, pl->next_offset, NULL);
+}
+
+static void restore_list (struct parked_list *pl)
+{
+	char *prev;
+	int i;
+
+	prev = pl->head;
+	for (i = 0; i < pl->count; i++) {
+		set_link (prev, pl->next_offset, pl->nodes[i]);
+		prev = pl->nodes[i];
+	}
+	set_link (prev, pl->next_offset, NULL);
+	free (pl->nodes);
+	pl->nodes = NULL;
+}
+
+/* the parked span's surge impedance already appears in Ybus, so it is
+taken out and put back by terminate_pole, which also adds the dc source
+that the span's history currents used to supply */
+
+static void terminate_edge (struct pole *ptr)
+{
+	struct window_edge *e = &edges [number_of_edges++];
+
+	e->pole = ptr;
+	e->solve = ptr->solve;
+	if (!(e->Ybus = gsl_matrix_alloc (number_of_nodes, number_of_nodes))) {
+		if (logfp) fprintf (logfp, "can't allocate spatial window\n");
+		oe_exit (ERR_MALLOC);
+	}
+	gsl_matrix_memcpy (e->Ybus, ptr->Ybus);
+	gsl_matrix_sub (ptr->Ybus, span_head->Yp);
+	terminate_pole (ptr, span_head);
+	ptr->solve = TRUE;
+	ptr->dirty = TRUE;
+}
+
+int open_spatial_window (int struck_pole)
+{
+	struct line *ln;
+	double tau;
+	int reach, farthest, half_width, distance, i;
+
+	if (using_network || !line_head->next || number_parked > 0) {
+		return FALSE;
+	}
+	ln = line_head->next;
+	tau = ln->alloc_steps * first_dT;
+	reach = (int) (Tmax / tau);
+
+/* find the farthest insulator or LPM that the stroke can reach */
+	farthest = 0;
+	insulator_ptr = insulator_head;
+	while ((insulator_ptr = insulator_ptr->next) != NULL) {
+		distance = abs (insulator_ptr->parent->location - struck_pole);
+		if (distance <= reach && distance > farthest) farthest = distance;
+	}
+	lpm_ptr = lpm_head;
+	while ((lpm_ptr = lpm_ptr->next) != NULL) {
+		distance = abs (lpm_ptr->parent->location - struck_pole);
+		if (distance <= reach && distance > farthest) farthest = distance;
+	}
+	half_width = (reach + farthest) / 2 + 1;  /* 2 * half_width - farthest > reach */
+	window_first_pole = struck_pole - half_width;
+	window_last_pole = struck_pole + half_width;
+	if (window_first_pole <= 1 && window_last_pole >= number_of_poles) {
+		return FALSE;  /* the stroke can reach both ends of the line */
+	}
+	if (window_first_pole < 1) window_first_pole = 1;
+	if (window_last_pole > number_of_poles) window_last_pole = number_of_poles;
+	if (logfp) {
+		fprintf (logfp, "spatial window for pole %d: poles %d to %d\n",
+			struck_pole, window_first_pole, window_last_pole);
+	}
+
+/* park everything outside the window, but keep the original order */
+	number_parked = 0;
+	add_list (PARK_POLE, (char *) pole_head, offsetof (struct pole, next), 0);
+	add_list (PARK_LINE, (char *) line_head, offsetof (struct line, next), 0);
+	ADD_COMPONENT_LIST (source, source_head);
+	ADD_STROKE_LIST (surge, surge_head);
+	ADD_STROKE_LIST (steepfront, steepfront_head);
+	ADD_COMPONENT_LIST (ground, ground_head);
+	ADD_COMPONENT_LIST (inductor, inductor_head);
+	ADD_COMPONENT_LIST (capacitor, capacitor_head);
+	ADD_COMPONENT_LIST (customer, customer_head);
+	ADD_COMPONENT_LIST (insulator, insulator_head);
+	ADD_COMPONENT_LIST (arrester, arrester_head);
+	ADD_COMPONENT_LIST (pipegap, pipegap_head);
+	ADD_COMPONENT_LIST (lpm, lpm_head);
+	ADD_COMPONENT_LIST (arrbez, arrbez_head);
+	for (i = 0; i < number_parked; i++) {
+		park_list (&parked[i]);
+	}
+
+/* terminate the window edges, adding sources at the end of the list */
+	source_tail = source_head;
+	while (source_tail->next) {
+		source_tail = source_tail->next;
+	}
+	source_ptr = source_tail;
+	number_of_edges = 0;
+	if (window_first_pole > 1) {
+		terminate_edge (find_pole (window_first_pole));
+	}
+	if (window_last_pole < number_of_poles) {
+		terminate_edge (find_pole (window_last_pole));
+	}
+	return TRUE;
+}
+
+void close_spatial_window (void)
+{
+	struct source *s_ptr;
+	int i;
+
+	if (number_parked < 1) {
+		return;
+	}
+	while ((s_ptr = source_tail->next) != NULL) {
+		source_tail->next = s_ptr->next;
+		gsl_vector_free (s_ptr->val);
+		free (s_ptr);
+	}
+	source_ptr = source_tail;
+	for (i = 0; i < number_parked; i++) {
+		restore_list (&parked[i]);
+	}
+	number_parked = 0;
+	for (i = 0; i < number_of_edges; i++) {
+		gsl_matrix_memcpy (edges[i].pole->Ybus, edges[i].Ybus);
+		gsl_matrix_free (edges[i].Ybus);
+		edges[i].pole->solve = edges[i].solve;
+		edges[i].pole->dirty = TRUE;
+	}
+	number_of_edges = 0;
+	window_first_pole = 1;
+	window_last_pole = number_of_poles;
+}
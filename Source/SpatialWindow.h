@@ -0,0 +1,35 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef spatialwindow_included
+#define spatialwindow_included
+
+/* While a window is open, the component lists hold only the poles that a
+stroke at the struck pole can influence before Tmax, and the other poles and
+their components are parked.  The insulator and LPM answers inside the window
+match those of the full model. */
+
+extern int window_first_pole;  /* pole numbers at the window edges */
+extern int window_last_pole;
+
+int open_spatial_window (int struck_pole);  /* FALSE if no poles can be parked */
+void close_spatial_window (void);  /* restore the full model */
+
+#endif
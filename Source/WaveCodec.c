@@ -0,0 +1,142 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/* This module contains the waveform codec used by the monitors, the LPM
+tangent waveforms and the compressed binary plot file.
+
+Sample k is quantized to q[k] = round (v[k] / quantum), and the code
+holds r[k] = q[k] - (2 q[k-1] - q[k-2]), with q[-1] = q[-2] = 0.  Over
+a smooth surge r is a few quanta, so each sample takes one or two bytes:
+r is mapped to an unsigned zigzag value (0, -1, 1, -2 ... to 0, 1, 2,
+3 ...) and written seven bits to a byte, low bits first, with the high
+bit set on every byte but the last. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "OETypes.h"
+#include "WaveCodec.h"
+
+#define WAVE_CODE_FIRST_SIZE 1024
+#define WAVE_CODE_MAX_BYTES 10  /* for one 64-bit residual */
+#define WAVE_QUANTA_LIMIT 1.0e18  /* keeps the prediction within a long long */
+
+void init_wave_code (struct wave_code *code, double quantum)
+{
+	code->quantum = quantum > 0.0 ? quantum : 1.0;
+	code->size = 0;
+	code->bytes = NULL;
+	reset_wave_code (code);
+}
+
+void reset_wave_code (struct wave_code *code)
+{
+	code->n = 0;
+	code->used = 0;
+	code->q1 = code->q2 = 0;
+}
+
+void append_wave_code (struct wave_code *code, double v)
+{
+	double x = v / code->quantum;
+	long long q, r;
+	unsigned long long z;
+	unsigned char *p;
+
+	if (code->used + WAVE_CODE_MAX_BYTES > code->size) {
+		code->size = code->size > 0 ? 2 * code->size : WAVE_CODE_FIRST_SIZE;
+		if (!(code->bytes = (unsigned char *) realloc (code->bytes, code->size))) {
+			if (logfp) fprintf (logfp, "can't allocate waveform code\n");
+			oe_exit (ERR_MALLOC);
+		}
+	}
+	if (x > WAVE_QUANTA_LIMIT) x = WAVE_QUANTA_LIMIT;
+	if (x < -WAVE_QUANTA_LIMIT) x = -WAVE_QUANTA_LIMIT;
+	if (x != x) x = 0.0;  /* NaN */
+	q = llround (x);
+	r = q - (2 * code->q1 - code->q2);
+	z = ((unsigned long long) r << 1) ^ (unsigned long long) (r >> 63);
+	p = code->bytes + code->used;
+	while (z >= 0x80) {
+		*p++ = (unsigned char) (z | 0x80);
+		z >>= 7;
+	}
+	*p++ = (unsigned char) z;
+	code->used = (long) (p - code->bytes);
+	code->q2 = code->q1;
+	code->q1 = q;
+	++code->n;
+}
+
+double wave_code_error (const struct wave_code *code)
+{
+	return 0.5 * code->quantum;
+}
+
+void free_wave_code (struct wave_code *code)
+{
+	free (code->bytes);
+	code->bytes = NULL;
+	code->size = 0;
+	reset_wave_code (code);
+}
+
+void start_wave_decoder (struct wave_decoder *dec, const struct wave_code *code)
+{
+	dec->quantum = code->quantum;
+	dec->left = code->n;
+	dec->q1 = dec->q2 = 0;
+	dec->p = code->bytes;
+}
+
+double next_wave_value (struct wave_decoder *dec)
+{
+	unsigned long long z = 0;
+	int shift = 0;
+	long long q;
+
+	if (dec->left < 1) return 0.0;
+	while (*dec->p & 0x80) {
+		z |= (unsigned long long) (*dec->p++ & 0x7f) << shift;
+		shift += 7;
+	}
+	z |= (unsigned long long) *dec->p++ << shift;
+	q = (long long) (z >> 1) ^ -(long long) (z & 1);
+	q += 2 * dec->q1 - dec->q2;
+	dec->q2 = dec->q1;
+	dec->q1 = q;
+	--dec->left;
+	return (double) q * dec->quantum;
+}
+
+int decode_wave (const struct wave_code *code, double *out, int n)
+{
+	struct wave_decoder dec;
+	int i;
+
+	start_wave_decoder (&dec, code);
+	if (n > code->n) n = code->n;
+	for (i = 0; i < n; i++) {
+		out[i] = next_wave_value (&dec);
+	}
+	return n;
+}
@@ -0,0 +1,58 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef wavecodec_included
+#define wavecodec_included
+
+/* A lossy codec for smooth waveforms.  Each sample is rounded to a
+multiple of the quantum, predicted from the two before it by a straight
+line, and only the error of the prediction is kept, as a variable-length
+integer.  The decoded samples are within half a quantum of the input. */
+
+struct wave_code {
+	double quantum;
+	int n;  /* samples encoded */
+	long used;  /* bytes in use */
+	long size;  /* bytes allocated, kept across resets */
+	long long q1, q2;  /* the last two quantized samples */
+	unsigned char *bytes;
+};
+
+/* reads a wave_code from the start, without allocating */
+
+struct wave_decoder {
+	double quantum;
+	int left;  /* samples not yet decoded */
+	long long q1, q2;
+	const unsigned char *p;
+};
+
+void init_wave_code (struct wave_code *code, double quantum);
+void reset_wave_code (struct wave_code *code);  /* empty, keeping the allocation */
+void append_wave_code (struct wave_code *code, double v);
+double wave_code_error (const struct wave_code *code);  /* bound on |decoded - input| */
+void free_wave_code (struct wave_code *code);
+
+void start_wave_decoder (struct wave_decoder *dec, const struct wave_code *code);
+double next_wave_value (struct wave_decoder *dec);  /* 0 after the last sample */
+int decode_wave (const struct wave_code *code, double *out, int n);  /* returns samples decoded */
+
+#endif
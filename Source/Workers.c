@@ -0,0 +1,140 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* This file contains functions to run simulations in worker processes.
+Only the parent writes to the log and output files; the workers get copies
+of the model at the time they start, and exit when their job returns or the
+parent stops reading.  Without fork, count_workers always returns 1 and the
+callers do the work themselves. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef linux
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#include "OETypes.h"
+#include "Workers.h"
+
+#ifdef linux
+static int number_of_workers = 0;
+static int *pipes = NULL;  /* read ends, in the parent */
+static pid_t *pids = NULL;
+static int child_fd = -1;  /* write end, in a worker */
+#endif
+
+int count_workers (int requested, int jobs)
+{
+	int workers = requested;
+
+#ifdef linux
+	if (workers < 1) workers = (int) sysconf (_SC_NPROCESSORS_ONLN);
+	if (workers > jobs) workers = jobs;
+#else
+	workers = 1;
+#endif
+	if (workers < 1) workers = 1;
+	return workers;
+}
+
+void start_workers (int workers, worker_job job, void *data)
+{
+#ifdef linux
+	int fd [2], w, k;
+
+	pipes = (int *) malloc (workers * sizeof (int));
+	pids = (pid_t *) malloc (workers * sizeof (pid_t));
+	if (!pipes || !pids) {
+		if (logfp) fprintf (logfp, "can't allocate worker processes\n");
+		oe_exit (ERR_MALLOC);
+	}
+	if (logfp) fflush (logfp);
+	if (op) fflush (op);
+	fflush (stdout);
+	for (w = 0; w < workers; w++) {
+		if (pipe (fd) != 0 || (pids[w] = fork ()) < 0) {
+			if (logfp) fprintf (logfp, "can't start worker process %d\n", w);
+			oe_exit (ERR_LT_STOPPED);
+		}
+		if (pids[w] == 0) {
+			close (fd[0]);
+			for (k = 0; k < w; k++) {
+				close (pipes[k]);
+			}
+			child_fd = fd[1];
+			logfp = NULL;
+			op = NULL;
+			job (w, workers, data);
+			close (child_fd);
+			_exit (0);
+		}
+		close (fd[1]);
+		pipes[w] = fd[0];
+	}
+	number_of_workers = workers;
+#endif
+}
+
+void send_to_parent (const void *buf, size_t n)
+{
+#ifdef linux
+	if (write (child_fd, buf, n) != (ssize_t) n) {
+		_exit (0);  /* the parent has stopped reading */
+	}
+#endif
+}
+
+void receive_from_worker (int w, void *buf, size_t n)
+{
+#ifdef linux
+	size_t got = 0;
+	ssize_t r;
+
+	while (got < n) {
+		r = read (pipes[w], (char *) buf + got, n - got);
+		if (r <= 0) {
+			if (logfp) fprintf (logfp, "worker process %d stopped before sending its answers\n", w);
+			oe_exit (ERR_LT_STOPPED);
+		}
+		got += r;
+	}
+#endif
+}
+
+void stop_workers (void)
+{
+#ifdef linux
+	int w;
+
+	for (w = 0; w < number_of_workers; w++) {
+		close (pipes[w]);
+		kill (pids[w], SIGTERM);
+		waitpid (pids[w], NULL, 0);
+	}
+	free (pipes);
+	free (pids);
+	pipes = NULL;
+	pids = NULL;
+	number_of_workers = 0;
+#endif
+}
@@ -0,0 +1,36 @@
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef workers_included
+#define workers_included
+
+/* Independent simulations run in forked copies of the process, because the
+model lives in global lists.  Worker w of W sends its answers back through
+its own pipe, in the order that it computes them. */
+
+typedef void (*worker_job) (int w, int workers, void *data);
+
+int count_workers (int requested, int jobs);  /* 1 where processes can't be forked */
+void start_workers (int workers, worker_job job, void *data);
+void send_to_parent (const void *buf, size_t n);  /* called from a job */
+void receive_from_worker (int w, void *buf, size_t n);
+void stop_workers (void);
+
+#endif
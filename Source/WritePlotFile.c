@@ -1,391 +1,1263 @@
-/*
-  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
-  Electric Power Research Institute, Inc.
-  All rights reserved.
-  
-  This file is part of OpenETran.
-
-  OpenETran is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, using only version 3 of the License.
-
-  OpenETran is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
-
-  You should have received a copy of the GNU General Public License
-  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-#include <string.h>
-#include <math.h>
-#include <limits.h>
-
-#include "OETypes.h"
-#include "Components/Meter.h"
-#include "WritePlotFile.h"
-
-static char delim = ',';
-
-typedef unsigned short USHORT;
-
-#define STO_VNAME_SIZE       9
-#define STO_INAME_SIZE       9
-#define STO_TITLE_SIZE       80
-#define STO_SIGNATURE_SIZE   16
-
-#pragma pack(2)
-
-struct OutputFileHeader
-    {
-    USHORT      size;               //  size of this header
-    char        szSignature [STO_SIGNATURE_SIZE];
-    USHORT      idVersionMajor;
-    USHORT      idVersionMinor;
-    double      dFBase; // Frequency base (Hertz)
-    double      dVBase; // Default voltage base (Volts)
-
-//    time_t      tStart;
-//    time_t      tFinish;
-// sizeof time_t increased in VS2005
-//    _int32      tStart;
-//    _int32      tFinish;
-    int         tStart;
-    int         tFinish;
-
-    double      dTStart;
-    double      dTFinish;
-    double      dDeltaT;
-
-    USHORT      nStep;
-
-    USHORT      nVoltage;
-    USHORT      nCurrent;
-
-    USHORT      sizeVoltageName;    //  size of voltage name
-    USHORT      sizeCurrentName;    //  size of current name
-
-    long        idxVoltageNames;    //  beginning of voltage name list
-    long        idxCurrentNames;    //  beginning of current name list
-    long        idxBaseData;        //  beginning of base voltage info (0 if none)
-    long        idxData;            //  beginning of output data
-
-    char        szTitle1 [STO_TITLE_SIZE];
-    char        szTitle2 [STO_TITLE_SIZE];
-    char        szTitle3 [STO_TITLE_SIZE];
-    char        szTitle4 [STO_TITLE_SIZE];
-    char        szTitle5 [STO_TITLE_SIZE];
-    };
-
-static struct OutputFileHeader ofh;
-
-static struct meter *CopyMeter (struct meter *ptr,
-	struct meter **first_new, struct meter **last_mtr)
-{
-	struct meter *next_mtr;
-
-	next_mtr = (struct meter *) malloc (sizeof *next_mtr);
-	if (!next_mtr) {
-		printf ("can't allocate new voltmeter\n");
-		exit (EXIT_FAILURE);
-	}
-	next_mtr->at = ptr->at;
-	next_mtr->from = ptr->from;
-	next_mtr->to = ptr->to;
-	next_mtr->vmax = ptr->vmax;
-	next_mtr->v_from = ptr->v_from;
-	next_mtr->v_to = ptr->v_to;
-	next_mtr->next = NULL;
-	
-	if (!(*first_new)) {
-		*first_new = next_mtr;
-	}
-	if (*last_mtr) {
-		(*last_mtr)->next = next_mtr;
-	}
-	*last_mtr = next_mtr;
-	return next_mtr;
-}
-
-static void SortMetersAndFigureIndices (struct meter *head)
-{
-	struct meter *ptr = head;
-	struct meter *first_new = NULL;
-	struct meter *last_mtr = NULL;
-	struct meter *next_mtr;
-
-/* build a new list of meter in two passes, first for voltage, then current */
-	while ((ptr = ptr->next)) {
-		if (ptr->to >= 0) {
-			next_mtr = CopyMeter (ptr, &first_new, &last_mtr);
-		}
-	}
-	ptr = head;
-	while ((ptr = ptr->next)) {
-		if (ptr->to < 0) {
-			next_mtr = CopyMeter (ptr, &first_new, &last_mtr);
-		}
-	}
-
-/* clean up and patch in the re-ordered list of meters */
-	ptr = head->next;
-	while (ptr) {
-		next_mtr = ptr->next;
-		free (ptr);
-		ptr = next_mtr;
-	}
-	head->next = first_new;
-}
-
-void InitializeSTOOutput (struct meter *head, double dT, double Tmax)
-{
-	struct meter *ptr = head;
-
-	ofh.size = sizeof ofh;
-    strncpy (ofh.szSignature, "OpenETran 1.00", STO_SIGNATURE_SIZE);
-    ofh.idVersionMajor = 2;
-    ofh.idVersionMinor = 0;
-    ofh.dFBase = 376.999;
-    ofh.dVBase = 1.0;
-
-    ofh.tStart  = 0; // time (NULL);
-    ofh.tFinish = 0; // time (NULL);
-
-    ofh.dTStart  = 0.0;
-    ofh.dTFinish = Tmax;
-    ofh.dDeltaT  = dT;
-
-    ofh.nStep = 0;
-
-    ofh.nVoltage = 0;
-    ofh.nCurrent = 0;
-
-    ofh.sizeVoltageName = STO_VNAME_SIZE;
-    ofh.sizeCurrentName = STO_INAME_SIZE;
-
-    ofh.idxVoltageNames = 0;
-    ofh.idxCurrentNames = 0;
-    ofh.idxBaseData = 0;
-    ofh.idxData = 0;
-
-    ofh.szTitle1[0] = 0;
-    ofh.szTitle2[0] = 0;
-    ofh.szTitle3[0] = 0;
-    ofh.szTitle4[0] = 0;
-    ofh.szTitle5[0] = 0;
-
-    strcpy (ofh.szTitle1, "EPRI OpenETran Transient Simulation");
-
-/* figure out the file positions */
-
-	while ((ptr = ptr->next)) {
-		if (ptr->to >= 0) {
-			++ofh.nVoltage;
-		} else {
-			++ofh.nCurrent;
-		}
-	}
-
-	ofh.idxVoltageNames = ofh.size;
-	ofh.idxCurrentNames =
-		ofh.idxVoltageNames + ofh.sizeVoltageName * ofh.nVoltage;
-	ofh.idxData         =
-		ofh.idxCurrentNames + ofh.sizeCurrentName * ofh.nCurrent;
-}
-
-static void trim_buf (char *buf, unsigned int max_len)
-{
-	char *pc;
-
-	if (strlen (buf) > max_len) {
-		pc = strchr (buf, '_');
-		while (pc && *pc) {
-			*pc = ' ';
-			++pc;
-		}
-	}
-	buf [max_len] = '\0';
-}
-
-void WriteSTOHeader (struct meter *head)
-{
-	struct meter *ptr = head;
-	USHORT count = 0;
-	char buf [STO_INAME_SIZE + STO_VNAME_SIZE];
-	
-    fwrite (&ofh, sizeof ofh, 1, bp);
-	while ((ptr = ptr->next)) {
-		memset (buf, ' ', sizeof buf);
-		if (count < ofh.nVoltage) {
-			sprintf (buf, "V %s_%s%s",
-				pole_labels [ptr->at], phase_labels [ptr->from], phase_labels [ptr->to]);
-			trim_buf (buf, STO_VNAME_SIZE - 1);
-			fwrite (buf, STO_VNAME_SIZE, 1, bp);
-		} else {  /* a current meter */
-			if (ptr->to == IARR_FLAG) {
-				sprintf (buf, "Ia %s_%s",
-					pole_labels [ptr->at], phase_labels [ptr->from]);
-			} else if (ptr->to == IPG_FLAG) {
-				sprintf (buf, "PG %s_%s",
-					pole_labels [ptr->at], phase_labels [ptr->from]);
-			} else if (ptr->to == IHG_FLAG) {
-				sprintf (buf, "HG %s",
-					pole_labels [ptr->at]);
-			} else if (ptr->to == IX2_FLAG) {
-				sprintf (buf, "X2 %s",
-					pole_labels [ptr->at]);
-			} else if (ptr->to == IPD_FLAG) {
-				sprintf (buf, "PD %s_%s",
-					pole_labels [ptr->at], phase_labels [ptr->from]);
-			} else {
-				sprintf (buf, "Ib %s_%s",
-					pole_labels [ptr->at], phase_labels [ptr->from]);
-			}
-			trim_buf (buf, STO_INAME_SIZE - 1);
-			fwrite (buf, STO_INAME_SIZE, 1, bp);
-		}
-		++count;
-	}
-}
-
-void FinalizeSTOHeader (double t, int step)
-{
-	ofh.tFinish = 0; // time (NULL);
-	ofh.dTFinish = t;
-	if (step > USHRT_MAX) {
-		ofh.nStep = USHRT_MAX;
-	} else {
-		ofh.nStep = step;
-	}
-	rewind (bp);
-	fwrite (&ofh, sizeof ofh, 1, bp);
-}
-
-void FinalizeSTOTitles (char *line1, char *line2, char *line3, char *line4, char *line5)
-{
-    ofh.szTitle1[0] = 0;
-    ofh.szTitle2[0] = 0;
-    ofh.szTitle3[0] = 0;
-    ofh.szTitle4[0] = 0;
-    ofh.szTitle5[0] = 0;
-    if (line1) strncpy (ofh.szTitle1, line1, STO_TITLE_SIZE - 1);
-    if (line2) strncpy (ofh.szTitle2, line2, STO_TITLE_SIZE - 1);
-    if (line3) strncpy (ofh.szTitle3, line3, STO_TITLE_SIZE - 1);
-    if (line4) strncpy (ofh.szTitle4, line4, STO_TITLE_SIZE - 1);
-    if (line5) strncpy (ofh.szTitle5, line5, STO_TITLE_SIZE - 1);
-	rewind (bp);
-	fwrite (&ofh, sizeof ofh, 1, bp);
-}
-
-void WriteSTOTimeStep (struct meter *head, double t)
-{
-	double volts;
-	struct meter *ptr = head;
-
-	fwrite (&t, sizeof t, 1, bp);
-	while ((ptr = ptr->next)) {
-		volts = *(ptr->v_from) - *(ptr->v_to);
-		if (fabs (volts) > fabs (ptr->vmax)) {
-			ptr->vmax = volts;
-		}
-		fwrite (&volts, sizeof volts, 1, bp);
-	}
-}
-
-// tab or csv delimited plot functions
-
-void WriteTextHeader (struct meter *head)
-{
-	struct meter *ptr = head;
-
-	fprintf (bp, "Time%c", delim);
-	while ((ptr = ptr->next)) {
-		if (ptr->to >= 0) {
-			fprintf (bp, "P%d:%d-%d", ptr->at, ptr->from, ptr->to);
-		} else if (ptr->to == IARR_FLAG) {
-			fprintf (bp, "P%d:%d-IARR", ptr->at, ptr->from);
-		} else if (ptr->to == IPG_FLAG) {
-			fprintf (bp, "P%d:%d-IPG", ptr->at, ptr->from);
-		} else if (ptr->to == IHG_FLAG) {
-			fprintf (bp, "P%d:%d-IHG", ptr->at, ptr->from);
-		} else if (ptr->to == IX2_FLAG) {
-			fprintf (bp, "P%d:%d-IX2", ptr->at, ptr->from);
-		} else if (ptr->to == IPD_FLAG) {
-			fprintf (bp, "P%d:%d-IPIPE", ptr->at, ptr->from);
-		}
-		if (ptr->next) {
-			fputc (delim, bp);
-		} else {
-			fputc ('\n', bp);
-		}
-	}
-}
-
-void WriteTextTimeStep (struct meter *head, double t)
-{
-	double volts;
-	struct meter *ptr = head;
-
-	fprintf (bp, "%e%c", t, delim);
-	while ((ptr = ptr->next)) {
-		volts = *(ptr->v_from) - *(ptr->v_to);
-		if (fabs (volts) > fabs (ptr->vmax)) {
-			ptr->vmax = volts;
-		}
-		fprintf (bp, "%e", volts);
-		if (ptr->next) {
-			fputc (delim, bp);
-		} else {
-			fputc ('\n', bp);
-		}
-	}
-}
-
-// public plot functions
-
-void InitializePlotOutput (struct meter *head, double dT, double Tmax)
-{
-    SortMetersAndFigureIndices (head);
-	if (bp) {
-		if (plot_type == PLT_ELT) {
-			InitializeSTOOutput (head, dT, Tmax);
-			WriteSTOHeader (head);
-		} else {
-			if (plot_type == PLT_TAB) delim = '\t';
-			WriteTextHeader (head);
-		}
-	}
-}
-
-void FinalizePlotHeader (double t, int step)
-{
-	if (bp) {
-		if (plot_type == PLT_ELT) {
-			FinalizeSTOHeader (t, step);
-		}
-	}
-}
-
-void FinalizePlotTitles (char *line1, char *line2, char *line3, char *line4, char *line5)
-{
-	if (bp) {
-		if (plot_type == PLT_ELT) {
-			FinalizeSTOTitles (line1, line2, line3, line4, line5);
-		}
-	}
-}
-
-void WritePlotTimeStep (struct meter *head, double t)
-{
-	if (bp) {
-		if (plot_type == PLT_ELT) {
-			WriteSTOTimeStep (head, t);
-		} else {
-			WriteTextTimeStep (head, t);
-		}
-	}
-}
+/*
+  Copyright (c) 1992, 1994, 1998, 2002, 2011, 2012,  
+  Electric Power Research Institute, Inc.
+  All rights reserved.
+  
+  This file is part of OpenETran.
+
+  OpenETran is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, using only version 3 of the License.
+
+  OpenETran is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenETran.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#ifdef linux
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#include "OETypes.h"
+#include "Components/Meter.h"
+#include "WritePlotFile.h"
+#include "WaveCodec.h"
+
+static char delim = ',';
+static int plot_channels;  /* meters in the plot, after the time */
+static long plot_rows;  /* rows written, fewer than the steps when decimated */
+
+typedef unsigned short USHORT;
+
+#define STO_VNAME_SIZE       9
+#define STO_INAME_SIZE       9
+#define STO_TITLE_SIZE       80
+#define STO_SIGNATURE_SIZE   16
+
+#define BIN_SIGNATURE        "OEBPLOT"
+#define BIN_VERSION          2
+#define BIN_NAME_SIZE        24
+#define BIN_BLOCK_BYTES      (1 << 20)  /* aim for about this much data per block */
+#define BIN_MIN_BLOCK_STEPS  64
+#define BIN_CODED_SIZE       2  /* about the bytes per coded sample, for sizing blocks */
+
+#define TEXT_BUFFER_SIZE     (64 * 1024)
+#define TEXT_MAX_PRECISION   17  /* enough to read back every double */
+#define TEXT_FAST_PRECISION  11  /* most digits after the point scaled exactly enough in a double */
+
+#define PLOT_BLOCK_BYTES     (256 * 1024)  /* rows sampled before the writer gets them */
+#define PLOT_BLOCKS          4
+
+#pragma pack(2)
+
+struct OutputFileHeader
+    {
+    USHORT      size;               //  size of this header
+    char        szSignature [STO_SIGNATURE_SIZE];
+    USHORT      idVersionMajor;
+    USHORT      idVersionMinor;
+    double      dFBase; // Frequency base (Hertz)
+    double      dVBase; // Default voltage base (Volts)
+
+//    time_t      tStart;
+//    time_t      tFinish;
+// sizeof time_t increased in VS2005
+//    _int32      tStart;
+//    _int32      tFinish;
+    int         tStart;
+    int         tFinish;
+
+    double      dTStart;
+    double      dTFinish;
+    double      dDeltaT;
+
+    USHORT      nStep;
+
+    USHORT      nVoltage;
+    USHORT      nCurrent;
+
+    USHORT      sizeVoltageName;    //  size of voltage name
+    USHORT      sizeCurrentName;    //  size of current name
+
+    long        idxVoltageNames;    //  beginning of voltage name list
+    long        idxCurrentNames;    //  beginning of current name list
+    long        idxBaseData;        //  beginning of base voltage info (0 if none)
+    long        idxData;            //  beginning of output data
+
+    char        szTitle1 [STO_TITLE_SIZE];
+    char        szTitle2 [STO_TITLE_SIZE];
+    char        szTitle3 [STO_TITLE_SIZE];
+    char        szTitle4 [STO_TITLE_SIZE];
+    char        szTitle5 [STO_TITLE_SIZE];
+    };
+
+static struct OutputFileHeader ofh;
+
+static struct meter *CopyMeter (struct meter *ptr,
+	struct meter **first_new, struct meter **last_mtr)
+{
+	struct meter *next_mtr;
+
+	next_mtr = (struct meter *) malloc (sizeof *next_mtr);
+	if (!next_mtr) {
+		printf ("can't allocate new voltmeter\n");
+		exit (EXIT_FAILURE);
+	}
+	next_mtr->at = ptr->at;
+	next_mtr->from = ptr->from;
+	next_mtr->to = ptr->to;
+	next_mtr->vmax = ptr->vmax;
+	next_mtr->v_from = ptr->v_from;
+	next_mtr->v_to = ptr->v_to;
+	next_mtr->next = NULL;
+	
+	if (!(*first_new)) {
+		*first_new = next_mtr;
+	}
+	if (*last_mtr) {
+		(*last_mtr)->next = next_mtr;
+	}
+	*last_mtr = next_mtr;
+	return next_mtr;
+}
+
+static void SortMetersAndFigureIndices (struct meter *head)
+{
+	struct meter *ptr = head;
+	struct meter *first_new = NULL;
+	struct meter *last_mtr = NULL;
+	struct meter *next_mtr;
+
+/* build a new list of meter in two passes, first for voltage, then current */
+	while ((ptr = ptr->next)) {
+		if (ptr->to >= 0) {
+			next_mtr = CopyMeter (ptr, &first_new, &last_mtr);
+		}
+	}
+	ptr = head;
+	while ((ptr = ptr->next)) {
+		if (ptr->to < 0) {
+			next_mtr = CopyMeter (ptr, &first_new, &last_mtr);
+		}
+	}
+
+/* clean up and patch in the re-ordered list of meters */
+	ptr = head->next;
+	while (ptr) {
+		next_mtr = ptr->next;
+		free (ptr);
+		ptr = next_mtr;
+	}
+	head->next = first_new;
+}
+
+void InitializeSTOOutput (struct meter *head, double dT, double Tmax)
+{
+	struct meter *ptr = head;
+
+	ofh.size = sizeof ofh;
+    strncpy (ofh.szSignature, "OpenETran 1.00", STO_SIGNATURE_SIZE);
+    ofh.idVersionMajor = 2;
+    ofh.idVersionMinor = 0;
+    ofh.dFBase = 376.999;
+    ofh.dVBase = 1.0;
+
+    ofh.tStart  = 0; // time (NULL);
+    ofh.tFinish = 0; // time (NULL);
+
+    ofh.dTStart  = 0.0;
+    ofh.dTFinish = Tmax;
+    ofh.dDeltaT  = dT;
+
+    ofh.nStep = 0;
+
+    ofh.nVoltage = 0;
+    ofh.nCurrent = 0;
+
+    ofh.sizeVoltageName = STO_VNAME_SIZE;
+    ofh.sizeCurrentName = STO_INAME_SIZE;
+
+    ofh.idxVoltageNames = 0;
+    ofh.idxCurrentNames = 0;
+    ofh.idxBaseData = 0;
+    ofh.idxData = 0;
+
+    ofh.szTitle1[0] = 0;
+    ofh.szTitle2[0] = 0;
+    ofh.szTitle3[0] = 0;
+    ofh.szTitle4[0] = 0;
+    ofh.szTitle5[0] = 0;
+
+    strcpy (ofh.szTitle1, "EPRI OpenETran Transient Simulation");
+
+/* figure out the file positions */
+
+	while ((ptr = ptr->next)) {
+		if (ptr->to >= 0) {
+			++ofh.nVoltage;
+		} else {
+			++ofh.nCurrent;
+		}
+	}
+
+	ofh.idxVoltageNames = ofh.size;
+	ofh.idxCurrentNames =
+		ofh.idxVoltageNames + ofh.sizeVoltageName * ofh.nVoltage;
+	ofh.idxData         =
+		ofh.idxCurrentNames + ofh.sizeCurrentName * ofh.nCurrent;
+}
+
+static void trim_buf (char *buf, unsigned int max_len)
+{
+	char *pc;
+
+	if (strlen (buf) > max_len) {
+		pc = strchr (buf, '_');
+		while (pc && *pc) {
+			*pc = ' ';
+			++pc;
+		}
+	}
+	buf [max_len] = '\0';
+}
+
+void WriteSTOHeader (struct meter *head)
+{
+	struct meter *ptr = head;
+	USHORT count = 0;
+	char buf [STO_INAME_SIZE + STO_VNAME_SIZE];
+	
+    fwrite (&ofh, sizeof ofh, 1, bp);
+	while ((ptr = ptr->next)) {
+		memset (buf, ' ', sizeof buf);
+		if (count < ofh.nVoltage) {
+			sprintf (buf, "V %s_%s%s",
+				pole_labels [ptr->at], phase_labels [ptr->from], phase_labels [ptr->to]);
+			trim_buf (buf, STO_VNAME_SIZE - 1);
+			fwrite (buf, STO_VNAME_SIZE, 1, bp);
+		} else {  /* a current meter */
+			if (ptr->to == IARR_FLAG) {
+				sprintf (buf, "Ia %s_%s",
+					pole_labels [ptr->at], phase_labels [ptr->from]);
+			} else if (ptr->to == IPG_FLAG) {
+				sprintf (buf, "PG %s_%s",
+					pole_labels [ptr->at], phase_labels [ptr->from]);
+			} else if (ptr->to == IHG_FLAG) {
+				sprintf (buf, "HG %s",
+					pole_labels [ptr->at]);
+			} else if (ptr->to == IX2_FLAG) {
+				sprintf (buf, "X2 %s",
+					pole_labels [ptr->at]);
+			} else if (ptr->to == IPD_FLAG) {
+				sprintf (buf, "PD %s_%s",
+					pole_labels [ptr->at], phase_labels [ptr->from]);
+			} else {
+				sprintf (buf, "Ib %s_%s",
+					pole_labels [ptr->at], phase_labels [ptr->from]);
+			}
+			trim_buf (buf, STO_INAME_SIZE - 1);
+			fwrite (buf, STO_INAME_SIZE, 1, bp);
+		}
+		++count;
+	}
+}
+
+void FinalizeSTOHeader (double t, long step)
+{
+	ofh.tFinish = 0; // time (NULL);
+	ofh.dTFinish = t;
+	if (step > USHRT_MAX) {
+		ofh.nStep = USHRT_MAX;
+	} else {
+		ofh.nStep = step;
+	}
+	rewind (bp);
+	fwrite (&ofh, sizeof ofh, 1, bp);
+}
+
+void FinalizeSTOTitles (char *line1, char *line2, char *line3, char *line4, char *line5)
+{
+    ofh.szTitle1[0] = 0;
+    ofh.szTitle2[0] = 0;
+    ofh.szTitle3[0] = 0;
+    ofh.szTitle4[0] = 0;
+    ofh.szTitle5[0] = 0;
+    if (line1) strncpy (ofh.szTitle1, line1, STO_TITLE_SIZE - 1);
+    if (line2) strncpy (ofh.szTitle2, line2, STO_TITLE_SIZE - 1);
+    if (line3) strncpy (ofh.szTitle3, line3, STO_TITLE_SIZE - 1);
+    if (line4) strncpy (ofh.szTitle4, line4, STO_TITLE_SIZE - 1);
+    if (line5) strncpy (ofh.szTitle5, line5, STO_TITLE_SIZE - 1);
+	rewind (bp);
+	fwrite (&ofh, sizeof ofh, 1, bp);
+	fseek (bp, 0L, SEEK_END);
+}
+
+/* STO steps are the time and then each meter, the same as the rows */
+
+void WriteSTOSteps (const double *rows, int steps)
+{
+	fwrite (rows, sizeof (double), (size_t) steps * (plot_channels + 1), bp);
+}
+
+/* the column label of a meter, in plot files with names longer than STO */
+
+static void MeterLabel (char *buf, struct meter *ptr)
+{
+	if (ptr->to >= 0) {
+		sprintf (buf, "P%d:%d-%d", ptr->at, ptr->from, ptr->to);
+	} else if (ptr->to == IARR_FLAG) {
+		sprintf (buf, "P%d:%d-IARR", ptr->at, ptr->from);
+	} else if (ptr->to == IPG_FLAG) {
+		sprintf (buf, "P%d:%d-IPG", ptr->at, ptr->from);
+	} else if (ptr->to == IHG_FLAG) {
+		sprintf (buf, "P%d:%d-IHG", ptr->at, ptr->from);
+	} else if (ptr->to == IX2_FLAG) {
+		sprintf (buf, "P%d:%d-IX2", ptr->at, ptr->from);
+	} else if (ptr->to == IPD_FLAG) {
+		sprintf (buf, "P%d:%d-IPIPE", ptr->at, ptr->from);
+	} else {
+		buf[0] = '\0';
+	}
+}
+
+// chunked, columnar binary plot functions
+
+/* The binary plot file has fixed-width fields in the byte order of the
+machine that wrote it, with no use of long, so the layout is the same
+on every platform.  After the header and channel names come blocks of
+steps; each block has a block header, the times of its steps, then one
+column of samples per meter.  With -plot zip (sizeSample 0), each
+column is instead a 4-byte length and then the samples in the WaveCodec
+form, begun afresh in each block, to within dQuantum / 2.  An index of
+the blocks follows the last block, so a reader can seek to any time
+without scanning.  The header
+is written again at the end with the step, block and index counts.
+Every field is at its natural alignment, so pack(2) doesn't change it. */
+
+struct BinaryFileHeader
+    {
+    char        szSignature [8];    //  "OEBPLOT"
+    unsigned int idVersion;
+    unsigned int sizeHeader;        //  size of this header
+    unsigned int nChannel;          //  meters, voltages first, then currents
+    unsigned int sizeSample;        //  4 for float, 8 for double, 0 for coded samples
+    unsigned int sizeName;          //  size of each channel name
+    unsigned int nBlockStep;        //  steps in a full block
+    unsigned long long nStep;       //  total steps in the file
+    unsigned long long nBlock;
+    unsigned long long idxNames;    //  beginning of channel name list
+    unsigned long long idxData;     //  beginning of the first block
+    unsigned long long idxIndex;    //  beginning of the block index (0 if unfinished)
+    double      dTStart;
+    double      dTFinish;
+    double      dDeltaT;            //  first time step, may switch during the run
+    double      dQuantum;           //  quantum of coded samples, or 0
+    char        szTitle1 [STO_TITLE_SIZE];
+    char        szTitle2 [STO_TITLE_SIZE];
+    char        szTitle3 [STO_TITLE_SIZE];
+    char        szTitle4 [STO_TITLE_SIZE];
+    char        szTitle5 [STO_TITLE_SIZE];
+    };
+
+struct BinaryBlockHeader
+    {
+    unsigned long long nFirstStep;
+    unsigned int nStep;             //  steps in this block, nBlockStep except the last
+    unsigned int reserved;
+    double      dTFirst;
+    double      dTLast;
+    };
+
+struct BinaryBlockIndex
+    {
+    unsigned long long nFirstStep;
+    unsigned long long idxBlock;    //  file position of the block header
+    double      dTFirst;
+    double      dTLast;
+    };
+
+static struct BinaryFileHeader bfh;
+static struct wave_code *bin_codes = NULL;  /* one column per meter, for coded samples */
+static unsigned char *bin_block = NULL;  /* block header, times, then columns */
+static unsigned int bin_fill;  /* steps in bin_block */
+static struct BinaryBlockIndex *bin_index = NULL;
+static unsigned long long bin_index_size;
+static unsigned long long bin_position;  /* file position of the next block */
+
+static double *BinaryTimes (void)
+{
+	return (double *) (bin_block + sizeof (struct BinaryBlockHeader));
+}
+
+static unsigned char *BinaryColumn (unsigned int channel)
+{
+	return bin_block + sizeof (struct BinaryBlockHeader) + bfh.nBlockStep * sizeof (double)
+		+ (size_t) channel * bfh.nBlockStep * bfh.sizeSample;
+}
+
+void InitializeBinaryOutput (struct meter *head, double dT, double Tmax)
+{
+	struct meter *ptr = head;
+	unsigned int steps, i;
+	size_t sample;
+
+	memset (&bfh, 0, sizeof bfh);
+	strncpy (bfh.szSignature, BIN_SIGNATURE, sizeof bfh.szSignature);
+	bfh.idVersion = BIN_VERSION;
+	bfh.sizeHeader = sizeof bfh;
+	if (plot_type == PLT_BINZ) {
+		bfh.sizeSample = 0;
+		bfh.dQuantum = wave_quantum;
+	} else {
+		bfh.sizeSample = (plot_type == PLT_BIN32) ? sizeof (float) : sizeof (double);
+	}
+	sample = bfh.sizeSample ? bfh.sizeSample : BIN_CODED_SIZE;
+	bfh.sizeName = BIN_NAME_SIZE;
+	while ((ptr = ptr->next)) {
+		++bfh.nChannel;
+	}
+	steps = BIN_BLOCK_BYTES / (sizeof (double) + bfh.nChannel * sample);
+	bfh.nBlockStep = (steps < BIN_MIN_BLOCK_STEPS) ? BIN_MIN_BLOCK_STEPS : steps;
+	bfh.idxNames = sizeof bfh;
+	bfh.idxData = bfh.idxNames + (unsigned long long) bfh.nChannel * bfh.sizeName;
+	bfh.dTStart = 0.0;
+	bfh.dTFinish = Tmax;
+	bfh.dDeltaT = dT;
+	strcpy (bfh.szTitle1, "EPRI OpenETran Transient Simulation");
+
+	bin_block = (unsigned char *) malloc (sizeof (struct BinaryBlockHeader)
+		+ bfh.nBlockStep * (sizeof (double) + (size_t) bfh.nChannel * bfh.sizeSample));
+	if (bfh.sizeSample == 0) {
+		if (!(bin_codes = (struct wave_code *) malloc ((bfh.nChannel + 1) * sizeof *bin_codes))) {
+			printf ("can't allocate binary plot columns\n");
+			exit (EXIT_FAILURE);
+		}
+		for (i = 0; i < bfh.nChannel; i++) {
+			init_wave_code (&bin_codes[i], bfh.dQuantum);
+		}
+	}
+	bin_index_size = 16;
+	bin_index = (struct BinaryBlockIndex *) malloc (bin_index_size * sizeof *bin_index);
+	if (!bin_block || !bin_index) {
+		printf ("can't allocate binary plot buffers\n");
+		exit (EXIT_FAILURE);
+	}
+	bin_fill = 0;
+	bin_position = bfh.idxData;
+}
+
+void WriteBinaryHeader (struct meter *head)
+{
+	struct meter *ptr = head;
+	char buf [BIN_NAME_SIZE];
+
+	fwrite (&bfh, sizeof bfh, 1, bp);
+	while ((ptr = ptr->next)) {
+		memset (buf, 0, sizeof buf);
+		MeterLabel (buf, ptr);
+		fwrite (buf, sizeof buf, 1, bp);
+	}
+}
+
+/* write the filled steps as one block; a short last block has its
+columns moved down to follow each other before the single write */
+
+static void FlushBinaryBlock (void)
+{
+	struct BinaryBlockHeader *bbh = (struct BinaryBlockHeader *) bin_block;
+	double *times = BinaryTimes ();
+	unsigned char *dest;
+	size_t column = (size_t) bin_fill * bfh.sizeSample;
+	size_t size;
+	unsigned int i, coded;
+
+	if (bin_fill < 1) return;
+	bbh->nFirstStep = bfh.nStep;
+	bbh->nStep = bin_fill;
+	bbh->reserved = 0;
+	bbh->dTFirst = times[0];
+	bbh->dTLast = times[bin_fill - 1];
+	dest = (unsigned char *) (times + bin_fill);
+	if (bin_codes) {  /* the header and times, then each coded column */
+		size = dest - bin_block;
+		fwrite (bin_block, size, 1, bp);
+		for (i = 0; i < bfh.nChannel; i++) {
+			coded = (unsigned int) bin_codes[i].used;
+			fwrite (&coded, sizeof coded, 1, bp);
+			fwrite (bin_codes[i].bytes, 1, coded, bp);
+			size += sizeof coded + coded;
+			reset_wave_code (&bin_codes[i]);
+		}
+	} else {
+		for (i = 0; i < bfh.nChannel; i++) {
+			if (dest != BinaryColumn (i)) {
+				memmove (dest, BinaryColumn (i), column);
+			}
+			dest += column;
+		}
+		size = dest - bin_block;
+		fwrite (bin_block, size, 1, bp);
+	}
+
+	if (bfh.nBlock >= bin_index_size) {
+		bin_index_size *= 2;
+		bin_index = (struct BinaryBlockIndex *) realloc (bin_index, bin_index_size * sizeof *bin_index);
+		if (!bin_index) {
+			printf ("can't allocate binary plot index\n");
+			exit (EXIT_FAILURE);
+		}
+	}
+	bin_index[bfh.nBlock].nFirstStep = bfh.nStep;
+	bin_index[bfh.nBlock].idxBlock = bin_position;
+	bin_index[bfh.nBlock].dTFirst = bbh->dTFirst;
+	bin_index[bfh.nBlock].dTLast = bbh->dTLast;
+	++bfh.nBlock;
+	bfh.nStep += bin_fill;
+	bin_position += size;
+	bin_fill = 0;
+}
+
+void WriteBinarySteps (const double *rows, int steps)
+{
+	const double *row;
+	unsigned int i;
+
+	for (row = rows; row < rows + (size_t) steps * (plot_channels + 1); row += plot_channels + 1) {
+		BinaryTimes ()[bin_fill] = row[0];
+		for (i = 0; i < bfh.nChannel; i++) {
+			if (bin_codes) {
+				append_wave_code (&bin_codes[i], row[i + 1]);
+			} else if (bfh.sizeSample == sizeof (float)) {
+				((float *) BinaryColumn (i))[bin_fill] = (float) row[i + 1];
+			} else {
+				((double *) BinaryColumn (i))[bin_fill] = row[i + 1];
+			}
+		}
+		if (++bin_fill >= bfh.nBlockStep) {
+			FlushBinaryBlock ();
+		}
+	}
+}
+
+void FinalizeBinaryHeader (double t)
+{
+	unsigned int i;
+
+	FlushBinaryBlock ();
+	bfh.dTFinish = t;
+	bfh.idxIndex = bin_position;
+	fwrite (bin_index, sizeof *bin_index, (size_t) bfh.nBlock, bp);
+	rewind (bp);
+	fwrite (&bfh, sizeof bfh, 1, bp);
+	fseek (bp, 0L, SEEK_END);
+	free (bin_block);
+	free (bin_index);
+	bin_block = NULL;
+	bin_index = NULL;
+	if (bin_codes) {
+		for (i = 0; i < bfh.nChannel; i++) {
+			free_wave_code (&bin_codes[i]);
+		}
+		free (bin_codes);
+		bin_codes = NULL;
+	}
+}
+
+void FinalizeBinaryTitles (char *line1, char *line2, char *line3, char *line4, char *line5)
+{
+	bfh.szTitle1[0] = 0;
+	bfh.szTitle2[0] = 0;
+	bfh.szTitle3[0] = 0;
+	bfh.szTitle4[0] = 0;
+	bfh.szTitle5[0] = 0;
+	if (line1) strncpy (bfh.szTitle1, line1, STO_TITLE_SIZE - 1);
+	if (line2) strncpy (bfh.szTitle2, line2, STO_TITLE_SIZE - 1);
+	if (line3) strncpy (bfh.szTitle3, line3, STO_TITLE_SIZE - 1);
+	if (line4) strncpy (bfh.szTitle4, line4, STO_TITLE_SIZE - 1);
+	if (line5) strncpy (bfh.szTitle5, line5, STO_TITLE_SIZE - 1);
+	if (bin_block) {  /* the header is written again when finalized */
+		return;
+	}
+	rewind (bp);
+	fwrite (&bfh, sizeof bfh, 1, bp);
+	fseek (bp, 0L, SEEK_END);
+}
+
+// tab or csv delimited plot functions
+
+void WriteTextHeader (struct meter *head)
+{
+	struct meter *ptr = head;
+	char buf [BIN_NAME_SIZE];
+
+	fprintf (bp, "Time%c", delim);
+	while ((ptr = ptr->next)) {
+		MeterLabel (buf, ptr);
+		fputs (buf, bp);
+		if (ptr->next) {
+			fputc (delim, bp);
+		} else {
+			fputc ('\n', bp);
+		}
+	}
+}
+
+/* Text samples are formatted the same as printf "%.*e", but without
+printf.  The value is scaled by one exact power of ten, which leaves it
+within one rounding of the true digits, and only a value that lands
+too near a half on the last digit goes through sprintf.  Lines are
+gathered in text_buf and written when it fills. */
+
+static const double powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static char *text_buf = NULL;
+static size_t text_size, text_fill, text_line;  /* text_line is the longest possible line */
+static int text_precision;
+
+static int FormatSample (char *buf, double v, int prec)
+{
+	char *p = buf, *q;
+	double a, m, r, frac;
+	unsigned long long d;
+	int e10, k, tries;
+
+	if (!isfinite (v) || prec > TEXT_FAST_PRECISION) {
+		return sprintf (buf, "%.*e", prec, v);
+	}
+	a = fabs (v);
+	if (a == 0.0) {
+		e10 = 0;
+		d = 0;
+	} else {
+		e10 = (int) floor (log10 (a));
+		for (tries = 0; ; tries++) {  /* log10 may miss by one near a power of ten */
+			k = prec - e10;
+			if (tries > 2 || k > 22 || k < -22) {
+				return sprintf (buf, "%.*e", prec, v);
+			}
+			m = (k >= 0) ? a * powers_of_ten[k] : a / powers_of_ten[-k];
+			if (m < powers_of_ten[prec] - 0.5) {
+				--e10;
+			} else if (m >= powers_of_ten[prec + 1]) {
+				++e10;
+			} else {
+				break;
+			}
+		}
+		r = floor (m);
+		frac = m - r;
+		if (fabs (frac - 0.5) <= 4.0e-16 * m) {
+			return sprintf (buf, "%.*e", prec, v);
+		}
+		d = (unsigned long long) r + (frac > 0.5 ? 1 : 0);
+		if (d >= (unsigned long long) powers_of_ten[prec + 1]) {  /* rounded up to the next decade */
+			d /= 10;
+			++e10;
+		}
+	}
+	if (signbit (v)) *p++ = '-';
+	p += (prec > 0) ? prec + 2 : 1;  /* fill in the digits from the last */
+	q = p;
+	for (k = 0; k < prec; k++) {
+		*--q = (char) ('0' + d % 10);
+		d /= 10;
+	}
+	if (prec > 0) *--q = '.';
+	*--q = (char) ('0' + d);
+	*p++ = 'e';
+	if (e10 < 0) {
+		*p++ = '-';
+		e10 = -e10;
+	} else {
+		*p++ = '+';
+	}
+	if (e10 >= 100) {
+		*p++ = (char) ('0' + e10 / 100);
+		e10 %= 100;
+	}
+	*p++ = (char) ('0' + e10 / 10);
+	*p++ = (char) ('0' + e10 % 10);
+	*p = '\0';
+	return (int) (p - buf);
+}
+
+void InitializeTextOutput (void)
+{
+	text_precision = plot_precision;
+	if (text_precision < 0) text_precision = 0;
+	if (text_precision > TEXT_MAX_PRECISION) text_precision = TEXT_MAX_PRECISION;
+	text_line = (size_t) (plot_channels + 1) * (text_precision + 16) + 1;  /* -d.ddde-ddd and a delimiter */
+	text_size = (2 * text_line > TEXT_BUFFER_SIZE) ? 2 * text_line : TEXT_BUFFER_SIZE;
+	text_buf = (char *) malloc (text_size);
+	if (!text_buf) {
+		printf ("can't allocate text plot buffer\n");
+		exit (EXIT_FAILURE);
+	}
+	text_fill = 0;
+}
+
+static void FlushTextBuffer (void)
+{
+	if (text_fill > 0) {
+		fwrite (text_buf, 1, text_fill, bp);
+		text_fill = 0;
+	}
+}
+
+void WriteTextSteps (const double *rows, int steps)
+{
+	const double *row;
+	char *p;
+	int i;
+
+	for (row = rows; row < rows + (size_t) steps * (plot_channels + 1); row += plot_channels + 1) {
+		if (text_fill + text_line > text_size) {
+			FlushTextBuffer ();
+		}
+		p = text_buf + text_fill;
+		for (i = 0; i <= plot_channels; i++) {
+			p += FormatSample (p, row[i], text_precision);
+			*p++ = (i < plot_channels) ? delim : '\n';
+		}
+		text_fill = p - text_buf;
+	}
+}
+
+void FinalizeTextOutput (void)
+{
+	FlushTextBuffer ();
+	free (text_buf);
+	text_buf = NULL;
+}
+
+// plot writer thread
+
+/* The solver only samples the meters into rows of the time and each
+meter value, PLOT_BLOCK_BYTES of rows at a time.  Full blocks go on a
+ring of PLOT_BLOCKS, and a writer thread encodes them in the plot format
+while the solver goes on; the solver waits only when every block is
+queued.  Without threads or a second processor, each block is written
+as soon as it fills.  FinalizePlotHeader drains the ring and stops the
+thread before it finishes the file, and nothing else touches bp while
+the thread runs. */
+
+struct plot_block {
+	int steps;
+	double *rows;
+};
+
+static struct plot_block plot_blocks [PLOT_BLOCKS];
+static int plot_block_steps;  /* rows in a full block */
+static int plot_fill;  /* block the solver is filling */
+static void (*plot_encoder) (const double *rows, int steps);
+
+#ifdef linux
+static pthread_t plot_thread;
+static pthread_mutex_t plot_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t plot_ready = PTHREAD_COND_INITIALIZER;  /* a block is queued, or done */
+static pthread_cond_t plot_taken = PTHREAD_COND_INITIALIZER;  /* a block was written */
+static int plot_first;  /* oldest queued block */
+static int plot_queued;
+static int plot_done;
+static int plot_threaded = FALSE;
+
+static void *PlotWriter (void *arg)
+{
+	struct plot_block *blk;
+
+	pthread_mutex_lock (&plot_lock);
+	for (;;) {
+		while (plot_queued < 1 && !plot_done) {
+			pthread_cond_wait (&plot_ready, &plot_lock);
+		}
+		if (plot_queued < 1) break;
+		blk = &plot_blocks [plot_first];
+		pthread_mutex_unlock (&plot_lock);
+		plot_encoder (blk->rows, blk->steps);
+		pthread_mutex_lock (&plot_lock);
+		blk->steps = 0;
+		plot_first = (plot_first + 1) % PLOT_BLOCKS;
+		--plot_queued;
+		pthread_cond_signal (&plot_taken);
+	}
+	pthread_mutex_unlock (&plot_lock);
+	return NULL;
+}
+#endif
+
+static void StartPlotWriter (void (*encoder) (const double *rows, int steps))
+{
+	int i;
+
+	plot_encoder = encoder;
+	plot_block_steps = PLOT_BLOCK_BYTES / ((plot_channels + 1) * sizeof (double));
+	if (plot_block_steps < 1) plot_block_steps = 1;
+	for (i = 0; i < PLOT_BLOCKS; i++) {
+		plot_blocks[i].steps = 0;
+		plot_blocks[i].rows = (double *) malloc ((size_t) plot_block_steps * (plot_channels + 1) * sizeof (double));
+		if (!plot_blocks[i].rows) {
+			printf ("can't allocate plot blocks\n");
+			exit (EXIT_FAILURE);
+		}
+	}
+	plot_fill = 0;
+#ifdef linux
+	plot_first = plot_queued = 0;
+	plot_done = FALSE;
+	if (sysconf (_SC_NPROCESSORS_ONLN) > 1) {  /* one processor would only trade places */
+		plot_threaded = (pthread_create (&plot_thread, NULL, PlotWriter, NULL) == 0);
+		if (!plot_threaded && logfp) fprintf (logfp, "writing the plot file without a thread\n");
+	}
+#endif
+}
+
+/* queue the filled block, or write it now without a thread */
+
+static void QueuePlotBlock (void)
+{
+	struct plot_block *blk = &plot_blocks [plot_fill];
+
+	if (blk->steps < 1) return;
+#ifdef linux
+	if (plot_threaded) {
+		pthread_mutex_lock (&plot_lock);
+		++plot_queued;
+		pthread_cond_signal (&plot_ready);
+		while (plot_queued >= PLOT_BLOCKS) {
+			pthread_cond_wait (&plot_taken, &plot_lock);
+		}
+		pthread_mutex_unlock (&plot_lock);
+		plot_fill = (plot_fill + 1) % PLOT_BLOCKS;
+		return;
+	}
+#endif
+	plot_encoder (blk->rows, blk->steps);
+	blk->steps = 0;
+}
+
+/* wait until every queued block is in the file */
+
+static void DrainPlotWriter (void)
+{
+	QueuePlotBlock ();
+#ifdef linux
+	if (plot_threaded) {
+		pthread_mutex_lock (&plot_lock);
+		while (plot_queued > 0) {
+			pthread_cond_wait (&plot_taken, &plot_lock);
+		}
+		pthread_mutex_unlock (&plot_lock);
+	}
+#endif
+}
+
+static void StopPlotWriter (void)
+{
+	int i;
+
+	DrainPlotWriter ();
+#ifdef linux
+	if (plot_threaded) {
+		pthread_mutex_lock (&plot_lock);
+		plot_done = TRUE;
+		pthread_cond_signal (&plot_ready);
+		pthread_mutex_unlock (&plot_lock);
+		pthread_join (plot_thread, NULL);
+		plot_threaded = FALSE;
+	}
+#endif
+	for (i = 0; i < PLOT_BLOCKS; i++) {
+		free (plot_blocks[i].rows);
+		plot_blocks[i].rows = NULL;
+	}
+	plot_encoder = NULL;
+}
+
+static void WritePlotRow (const double *row)
+{
+	struct plot_block *blk = &plot_blocks [plot_fill];
+
+	memcpy (blk->rows + (size_t) blk->steps * (plot_channels + 1), row,
+		(plot_channels + 1) * sizeof (double));
+	++plot_rows;
+	if (++blk->steps >= plot_block_steps) {
+		QueuePlotBlock ();
+	}
+}
+
+// triggered capture
+
+/* With -capture PRE POST, the rows only reach the file from PRE seconds
+before to POST seconds after a trigger: an insulator or LPM flashover,
+an arrester sparkover, or with -threshold V, a voltage meter above V.
+Until then the rows wait in a ring long enough for PRE, and overlapping
+windows run together.  The rows come after decimation, so a window of
+peak rows keeps its extremes. */
+
+static int capture_on = FALSE;
+static double *capture_ring = NULL;
+static int ring_size, ring_first, ring_count;
+static double capture_from, capture_until;
+static int trigger_pending;
+static double trigger_time;
+
+static void InitializeCapture (double dT)
+{
+	capture_on = plot_capture;
+	if (!capture_on) return;
+	if (plot_capture_pre < 0.0) plot_capture_pre = 0.0;
+	ring_size = (int) ceil (plot_capture_pre / dT) + 4;
+	capture_ring = (double *) malloc ((size_t) ring_size * (plot_channels + 1) * sizeof (double));
+	if (!capture_ring) {
+		printf ("can't allocate plot capture ring\n");
+		exit (EXIT_FAILURE);
+	}
+	ring_first = ring_count = 0;
+	capture_from = 0.0;
+	capture_until = -1.0;  /* no window yet */
+	trigger_pending = FALSE;
+}
+
+/* called by the components when something happens at time at */
+
+void TriggerPlotCapture (double at)
+{
+	if (!capture_on) return;
+	if (!trigger_pending || at < trigger_time) {
+		trigger_time = at;
+	}
+	trigger_pending = TRUE;
+}
+
+/* open or extend the window around the trigger, and write the rows
+in the ring that fall inside it */
+
+static void OpenCaptureWindow (double at)
+{
+	double *row;
+	int k;
+
+	if (capture_until >= 0.0 && at - plot_capture_pre <= capture_until) {
+		if (at + plot_capture_post > capture_until) {
+			capture_until = at + plot_capture_post;
+		}
+	} else {
+		capture_from = at - plot_capture_pre;
+		capture_until = at + plot_capture_post;
+	}
+	for (k = 0; k < ring_count; k++) {
+		row = capture_ring + (size_t) ((ring_first + k) % ring_size) * (plot_channels + 1);
+		if (row[0] >= capture_from) {
+			WritePlotRow (row);
+		}
+	}
+	ring_first = ring_count = 0;
+	trigger_pending = FALSE;
+}
+
+static void AppendPlotRow (const double *row)
+{
+	int k;
+
+	if (!capture_on || (row[0] >= capture_from && row[0] <= capture_until)) {
+		WritePlotRow (row);
+		return;
+	}
+	if (ring_count < ring_size) {
+		k = (ring_first + ring_count++) % ring_size;
+	} else {  /* overwrite the oldest */
+		k = ring_first;
+		ring_first = (ring_first + 1) % ring_size;
+	}
+	memcpy (capture_ring + (size_t) k * (plot_channels + 1), row, (plot_channels + 1) * sizeof (double));
+}
+
+static void FinalizeCapture (void)
+{
+	free (capture_ring);
+	capture_ring = NULL;
+	capture_on = FALSE;
+}
+
+// plot decimation
+
+/* Every step is sampled into plot_row, and vmax is kept from it at the
+full rate, but -decimate can thin out the rows that reach the file:
+
+  step DT   the first row at or after each multiple of DT
+  peak DT   for each interval of DT, two rows with the lowest and the
+            highest value of each meter, in the order they happened,
+            at the times of the first and last step in the interval
+  adapt E   a row, and the one before it, whenever any meter has moved
+            more than E per unit of its own peak since the last row
+
+The first and last steps are always written.  The time column of the
+rows is what a reader should use, because the rows are no longer dT
+apart. */
+
+static double *plot_row = NULL;  /* the step just sampled */
+static double *plot_prev;  /* the step before, for adapt */
+static double *plot_kept;  /* the last row written, for adapt */
+static double *peak_lo, *peak_hi;  /* per meter extremes in the interval, for peak */
+static double *peak_first, *peak_second;  /* the two rows written for an interval */
+static long *peak_lo_step, *peak_hi_step;
+static long plot_step;  /* steps sampled */
+static int prev_written;
+static double next_output;  /* time of the next step row */
+static long bucket;  /* interval number for peak */
+static long bucket_steps;
+static double bucket_first, bucket_last;
+
+static void InitializeDecimation (void)
+{
+	size_t n = plot_channels + 1;
+
+	plot_row = (double *) malloc (7 * n * sizeof (double));
+	peak_lo_step = (long *) malloc (2 * n * sizeof (long));
+	if (!plot_row || !peak_lo_step) {
+		printf ("can't allocate plot decimation\n");
+		exit (EXIT_FAILURE);
+	}
+	plot_prev = plot_row + n;
+	plot_kept = plot_prev + n;
+	peak_lo = plot_kept + n;
+	peak_hi = peak_lo + n;
+	peak_first = peak_hi + n;
+	peak_second = peak_first + n;
+	peak_hi_step = peak_lo_step + n;
+	plot_step = 0;
+	plot_rows = 0;
+	prev_written = TRUE;
+	next_output = 0.0;
+	bucket = -1;
+	bucket_steps = 0;
+	if (plot_decimation != DECIMATE_NONE && plot_decimation_value <= 0.0) {
+		plot_decimation = DECIMATE_NONE;
+	}
+}
+
+/* write the extremes of the finished interval, in the order they came */
+
+static void FlushPeakBucket (void)
+{
+	int i;
+
+	if (bucket_steps < 1) return;
+	peak_first[0] = bucket_first;
+	peak_second[0] = bucket_last;
+	for (i = 1; i <= plot_channels; i++) {
+		if (peak_lo_step[i] <= peak_hi_step[i]) {
+			peak_first[i] = peak_lo[i];
+			peak_second[i] = peak_hi[i];
+		} else {
+			peak_first[i] = peak_hi[i];
+			peak_second[i] = peak_lo[i];
+		}
+	}
+	AppendPlotRow (peak_first);
+	if (bucket_steps > 1) {
+		AppendPlotRow (peak_second);
+	}
+	bucket_steps = 0;
+}
+
+static void DecimatePeak (double t)
+{
+	long b = (long) floor (t / plot_decimation_value * (1.0 + 1.0e-12));
+	double v;
+	int i;
+
+	if (b != bucket) {
+		FlushPeakBucket ();
+		bucket = b;
+		bucket_first = t;
+	}
+	for (i = 1; i <= plot_channels; i++) {
+		v = plot_row[i];
+		if (bucket_steps < 1 || v < peak_lo[i]) {
+			peak_lo[i] = v;
+			peak_lo_step[i] = plot_step;
+		}
+		if (bucket_steps < 1 || v > peak_hi[i]) {
+			peak_hi[i] = v;
+			peak_hi_step[i] = plot_step;
+		}
+	}
+	bucket_last = t;
+	++bucket_steps;
+}
+
+static int MovedPastTolerance (struct meter *head)
+{
+	struct meter *ptr = head;
+	int i = 0;
+
+	while ((ptr = ptr->next)) {
+		++i;
+		if (fabs (plot_row[i] - plot_kept[i]) > plot_decimation_value * fabs (ptr->vmax)) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static void DecimateRow (struct meter *head, double t)
+{
+	size_t size = (plot_channels + 1) * sizeof (double);
+	int written = FALSE;
+
+	switch (plot_decimation) {
+		case DECIMATE_STEP:
+			if (t >= next_output * (1.0 - 1.0e-12)) {
+				AppendPlotRow (plot_row);
+				written = TRUE;
+				next_output = plot_decimation_value * (floor (t / plot_decimation_value * (1.0 + 1.0e-12)) + 1.0);
+			}
+			break;
+		case DECIMATE_PEAK:
+			DecimatePeak (t);
+			written = TRUE;  /* the bucket holds it */
+			break;
+		case DECIMATE_ADAPT:
+			if (plot_step < 1 || MovedPastTolerance (head)) {
+				if (!prev_written) {
+					AppendPlotRow (plot_prev);
+				}
+				AppendPlotRow (plot_row);
+				memcpy (plot_kept, plot_row, size);
+				written = TRUE;
+			}
+			break;
+		default:
+			AppendPlotRow (plot_row);
+			written = TRUE;
+			break;
+	}
+	prev_written = written;
+	if (!written) {
+		memcpy (plot_prev, plot_row, size);
+	}
+}
+
+static void FinalizeDecimation (void)
+{
+	if (plot_decimation == DECIMATE_PEAK) {
+		FlushPeakBucket ();
+	} else if (!prev_written && plot_step > 0) {  /* always end with the last step */
+		AppendPlotRow (plot_prev);
+	}
+	free (plot_row);
+	free (peak_lo_step);
+	plot_row = NULL;
+	peak_lo_step = NULL;
+}
+
+static void SamplePlotMeters (struct meter *head, double t)
+{
+	double *row = plot_row;
+	double volts;
+	struct meter *ptr = head;
+
+	*row++ = t;
+	while ((ptr = ptr->next)) {
+		volts = *(ptr->v_from) - *(ptr->v_to);
+		if (fabs (volts) > fabs (ptr->vmax)) {
+			ptr->vmax = volts;
+		}
+		*row++ = volts;
+		if (capture_on && plot_threshold > 0.0 && ptr->to >= 0 && fabs (volts) > plot_threshold) {
+			TriggerPlotCapture (t);
+		}
+	}
+	if (trigger_pending) {
+		OpenCaptureWindow (trigger_time);
+	}
+	DecimateRow (head, t);
+	++plot_step;
+}
+
+// public plot functions
+
+void InitializePlotOutput (struct meter *head, double dT, double Tmax)
+{
+	struct meter *ptr = head;
+
+    SortMetersAndFigureIndices (head);
+	plot_channels = 0;
+	while ((ptr = ptr->next)) {
+		++plot_channels;
+	}
+	if (bp) {
+		if (plot_type == PLT_ELT) {
+			InitializeSTOOutput (head, dT, Tmax);
+			WriteSTOHeader (head);
+			StartPlotWriter (WriteSTOSteps);
+			InitializeDecimation ();
+			InitializeCapture (dT);
+		} else if (plot_type == PLT_BIN || plot_type == PLT_BIN32 || plot_type == PLT_BINZ) {
+			InitializeBinaryOutput (head, dT, Tmax);
+			WriteBinaryHeader (head);
+			StartPlotWriter (WriteBinarySteps);
+			InitializeDecimation ();
+			InitializeCapture (dT);
+		} else {
+			if (plot_type == PLT_TAB) delim = '\t';
+			WriteTextHeader (head);
+			InitializeTextOutput ();
+			StartPlotWriter (WriteTextSteps);
+			InitializeDecimation ();
+			InitializeCapture (dT);
+		}
+	}
+}
+
+void FinalizePlotHeader (double t)
+{
+	if (bp) {
+		if (plot_encoder) {
+			FinalizeDecimation ();
+			FinalizeCapture ();
+			StopPlotWriter ();
+		}
+		if (plot_type == PLT_ELT) {
+			FinalizeSTOHeader (t, plot_rows);
+		} else if (plot_type == PLT_BIN || plot_type == PLT_BIN32 || plot_type == PLT_BINZ) {
+			FinalizeBinaryHeader (t);
+		} else {
+			FinalizeTextOutput ();
+		}
+	}
+}
+
+void FinalizePlotTitles (char *line1, char *line2, char *line3, char *line4, char *line5)
+{
+	if (bp) {
+		if (plot_encoder) DrainPlotWriter ();
+		if (plot_type == PLT_ELT) {
+			FinalizeSTOTitles (line1, line2, line3, line4, line5);
+		} else if (plot_type == PLT_BIN || plot_type == PLT_BIN32 || plot_type == PLT_BINZ) {
+			FinalizeBinaryTitles (line1, line2, line3, line4, line5);
+		}
+	}
+}
+
+void WritePlotTimeStep (struct meter *head, double t)
+{
+	if (bp && plot_encoder) {
+		SamplePlotMeters (head, t);
+	}
+}
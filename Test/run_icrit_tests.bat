@@ -1,4 +1,12 @@
 ..\openetran -icrit 16 16 1 1 1 test_icrit
 ..\openetran -icrit 17 17 1 1 1 test_icrit
 ..\openetran -plot elt test_icrit
-
+..\openetran -icrit 100 100 1 1 1 winfar
+..\openetran -window -icrit 100 100 1 1 1 winfar
+..\openetran -montecarlo 100 100 1 0 0 -samples 400 winfar
+..\openetran -montecarlo 100 100 1 0 0 -samples 400 -ishift 1 -tshift 0.5 -lhs winfar
+..\openetran -icrit 100 100 1 0 0 -fronts 8 1 8 winfar
+..\openetran -newton -icrit 16 16 1 1 1 test_icrit
+..\openetran -lanes 4 -icrit 16 16 1 1 1 test_icrit
+..\openetran -chord -icrit 16 16 1 1 1 test_icrit
+..\openetran -implicit -icrit 16 16 1 1 1 test_icrit